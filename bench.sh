@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# build and run every benchmark (or only those given as arguments), passing
+# any options in CXXFLAGS to the compiler, e.g. CXXFLAGS=-DUSE_ARENA_STORAGE=1,
+# and any options in BENCH_ARGS to the benchmarks themselves
+benches=("$@")
+if [ ${#benches[@]} -eq 0 ]; then
+	benches=(bench/*.cpp)
+fi
+
+for bench in "${benches[@]}"; do
+	echo "== $bench" >&2
+	g++ -std=c++17 -O2 -pthread $CXXFLAGS "$bench" src/ini.cpp -o bench_main || exit 1
+	./bench_main $BENCH_ARGS
+	rm bench_main
+done
@@ -0,0 +1,97 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs `reads` reads on each of `threads` threads at once.
+ * @returns The total number of reads per second.
+ */
+template <typename Read>
+static double readsPerSecond(unsigned threads, int reads, Read read) {
+	std::vector<std::thread> readers;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (unsigned t = 0; t < threads; ++t) {
+		readers.emplace_back([&, t]() {
+			long long checksum = 0;
+
+			for (int i = 0; i < reads; ++i) {
+				checksum += read(t + i);
+			}
+
+			// keep the work observable so it is not optimised away
+			if (checksum == 0) {
+				std::cout << "";
+			}
+		});
+	}
+
+	for (auto &reader : readers) {
+		reader.join();
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+	return threads * static_cast<double>(reads) / std::chrono::duration<double>(end - start).count();
+}
+
+int main() {
+	const char *fileName = "bench_accesses.ini";
+	GeneratorOptions options;
+	options.sections = 100;
+	const std::vector<GeneratedKey> keys = generateConfig(fileName, options);
+
+	std::vector<const GeneratedKey *> ints;
+	for (const auto &key : keys) {
+		if (key.type == ValueType::Int) {
+			ints.push_back(&key);
+		}
+	}
+
+	const INIReader reader(fileName);
+	const INIReader overlay = INIReader::fromLayers({ reader });
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+	const int reads = 4000000;
+
+	std::cout << "counting key accesses: " << (COUNT_KEY_ACCESSES ? "on" : "off") << '\n';
+
+	for (unsigned threads = 1; threads <= cores; threads *= 2) {
+		// one read in eight asks for a key that is not in the file
+		const double rate = readsPerSecond(threads, reads, [&](unsigned i) {
+			const GeneratedKey *key = ints[i % ints.size()];
+			return reader.getInt(key->section, (i % 8 == 0) ? "Missing" : key->key, 1);
+		});
+
+		// a base reader and an overlay read in turn, as with layered configurations
+		const double alternating = readsPerSecond(threads, reads, [&](unsigned i) {
+			const GeneratedKey *key = ints[i % ints.size()];
+			return ((i % 2 == 0) ? reader : overlay).getInt(key->section, key->key, 1);
+		});
+
+		std::cout << threads << " threads: " << rate / 1e6 << " M reads/s, alternating between two readers " << alternating / 1e6 << " M reads/s\n";
+
+		// always finish on the number of cores, even when it is not a power of two
+		if (threads < cores && threads * 2 > cores) {
+			threads = cores / 2;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::vector<KeyAccess> accesses = reader.getKeyAccesses();
+	const auto end = std::chrono::steady_clock::now();
+
+	std::cout << "collected " << accesses.size() << " keys in " << std::chrono::duration<double, std::micro>(end - start).count() << " us\n";
+
+	for (std::size_t i = 0; i < accesses.size() && i < 3; ++i) {
+		std::cout << "    [" << accesses[i].section << "] " << accesses[i].key << ": " << accesses[i].hits << " hits, " << accesses[i].misses << " misses\n";
+	}
+
+	std::remove(fileName);
+	return 0;
+}
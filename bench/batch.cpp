@@ -0,0 +1,107 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Times `fn` for every request and returns the cost per request in
+ * nanoseconds.
+ */
+template <typename Fn>
+static double nsPerRequest(std::size_t requests, int rounds, Fn fn) {
+	double checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int r = 0; r < rounds; ++r) {
+		for (std::size_t i = 0; i < requests; ++i) {
+			checksum += fn(i);
+		}
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	// keep the work observable so it is not optimised away
+	if (checksum == 0) {
+		std::cout << "";
+	}
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / (requests * rounds);
+}
+
+int main() {
+	const char *fileName = "bench_batch.ini";
+	const std::size_t perRequest = 40;
+
+	// a small file stays in the cache, a large one makes every probe a miss
+	for (const int sections : { 100, 20000 }) {
+		GeneratorOptions options;
+		options.sections = sections;
+		const std::vector<GeneratedKey> keys = generateConfig(fileName, options);
+		const INIReader reader(fileName, LoadMode::Mapped);
+
+		if (!reader.success()) {
+			std::cout << "failed to parse: " << reader.getError() << '\n';
+			return 1;
+		}
+
+		// each request reads 10 keys from each of 4 random sections, as a
+		// handler reading its settings would
+		std::mt19937 rng(7);
+		std::vector<std::vector<Lookup>> requests(1000);
+
+		for (auto &request : requests) {
+			for (std::size_t s = 0; s < perRequest / 10; ++s) {
+				const std::size_t section = rng() % sections;
+
+				for (std::size_t k = 0; k < 10; ++k) {
+					const GeneratedKey &key = keys[section * options.keysPerSection + k];
+
+					switch (key.type) {
+						case ValueType::String: request.emplace_back(key.section, key.key, "none"); break;
+						case ValueType::Int: request.emplace_back(key.section, key.key, 0); break;
+						case ValueType::Double: request.emplace_back(key.section, key.key, 0.0); break;
+						case ValueType::Bool: request.emplace_back(key.section, key.key, false); break;
+					}
+				}
+			}
+		}
+
+		const double single = nsPerRequest(requests.size(), 200, [&](std::size_t i) {
+			double sum = 0;
+
+			for (const Lookup &lookup : requests[i]) {
+				switch (lookup.type) {
+					case LookupType::String: sum += reader.getStringView(lookup.section, lookup.key, "none").length(); break;
+					case LookupType::Int: sum += reader.getInt(lookup.section, lookup.key, 0); break;
+					case LookupType::Long: sum += reader.getLong(lookup.section, lookup.key, 0); break;
+					case LookupType::Double: sum += reader.getDouble(lookup.section, lookup.key, 0.0); break;
+					case LookupType::Bool: sum += reader.getBool(lookup.section, lookup.key, false); break;
+				}
+			}
+
+			return sum;
+		});
+
+		LookupResult results[perRequest];
+		const double batch = nsPerRequest(requests.size(), 200, [&](std::size_t i) {
+			reader.getMany(requests[i].data(), requests[i].size(), results);
+
+			double sum = 0;
+			for (std::size_t k = 0; k < perRequest; ++k) {
+				sum += results[k].value.string.length() + results[k].value.integer + results[k].value.real + results[k].value.boolean;
+			}
+
+			return sum;
+		});
+
+		std::cout << sections * options.keysPerSection << " keys, " << perRequest << " per request: getters " << single
+			<< " ns, getMany " << batch << " ns (" << single / batch << "x)\n";
+	}
+
+	std::remove(fileName);
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * @brief Returns the best time in milliseconds of calling `load` `runs`
+ * times, where `load` returns the reader it created.
+ */
+template <typename Load>
+static double bestLoadMs(int runs, Load load) {
+	double best = 0.0;
+
+	for (int r = 0; r < runs; ++r) {
+		const auto start = std::chrono::steady_clock::now();
+		const INIReader reader = load();
+		const auto end = std::chrono::steady_clock::now();
+
+		if (!reader.success()) {
+			std::cout << "failed to parse: " << reader.getError() << '\n';
+			std::exit(1);
+		}
+
+		const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		best = (r == 0) ? ms : std::min(best, ms);
+	}
+
+	return best;
+}
+
+int main() {
+	const char *fileName = "bench_cache.ini";
+	const char *cacheName = "bench_cache.ini.cache";
+
+	GeneratorOptions options;
+	options.sections = 5000;
+	generateConfig(fileName, options);
+	std::remove(cacheName);
+
+	const double stream = bestLoadMs(5, [&]() { return INIReader(fileName); });
+	const double mapped = bestLoadMs(5, [&]() { return INIReader(fileName, LoadMode::Mapped); });
+
+	// the first load writes the cache, every later one uses it
+	const INIReader first = INIReader::fromCache(fileName, cacheName);
+	const double cached = bestLoadMs(5, [&]() { return INIReader::fromCache(fileName, cacheName); });
+
+	if (first.loadedFromCache() || !INIReader::fromCache(fileName, cacheName).loadedFromCache()) {
+		std::cout << "cache was not used\n";
+		return 1;
+	}
+
+	std::cout << "stream " << stream << " ms, mapped " << mapped << " ms, cache " << cached << " ms\n";
+
+	std::remove(fileName);
+	std::remove(cacheName);
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include "../src/ini.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Times `fn` for every key and returns the cost per call in nanoseconds.
+ */
+template <typename Fn>
+static double nsPerCall(const std::vector<std::string> &keys, int rounds, Fn fn) {
+	double checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int r = 0; r < rounds; ++r) {
+		for (const auto &key : keys) {
+			checksum += fn(key);
+		}
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	// keep the work observable so it is not optimised away
+	if (checksum == 0) {
+		std::cout << "";
+	}
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / (keys.size() * rounds);
+}
+
+int main() {
+	const char *fileName = "bench_convert.ini";
+	const int numKeys = 1000;
+	const int rounds = 1000;
+
+	std::vector<std::string> keys;
+	std::ofstream file(fileName);
+	for (int k = 0; k < numKeys; ++k) {
+		keys.push_back("value_" + std::to_string(k));
+	}
+
+	file << "[INTS]\n";
+	for (int k = 0; k < numKeys; ++k) {
+		file << keys[k] << " = " << k * 7919 << '\n';
+	}
+
+	file << "[DOUBLES]\n";
+	for (int k = 0; k < numKeys; ++k) {
+		file << keys[k] << " = " << k * 7919 << '.' << k % 100 << '\n';
+	}
+	file.close();
+
+	INIReader reader(fileName);
+	if (!reader.success()) {
+		std::cout << "failed to parse: " << reader.getError() << '\n';
+		return 1;
+	}
+
+	// the getters before the conversion layer copied the value and called std::sto*
+	const double stoiNs = nsPerCall(keys, rounds, [&](const std::string &key) {
+		return std::stoi(std::string(reader.getStringView("INTS", key, "0")));
+	});
+	const double stodNs = nsPerCall(keys, rounds, [&](const std::string &key) {
+		return std::stod(std::string(reader.getStringView("DOUBLES", key, "0")));
+	});
+
+	const double intNs = nsPerCall(keys, rounds, [&](const std::string &key) {
+		return reader.getInt("INTS", key, 1);
+	});
+	const double doubleNs = nsPerCall(keys, rounds, [&](const std::string &key) {
+		return reader.getDouble("DOUBLES", key, 0.0);
+	});
+
+	std::cout << "std::stoi: " << stoiNs << " ns, getInt: " << intNs << " ns\n";
+	std::cout << "std::stod: " << stodNs << " ns, getDouble: " << doubleNs << " ns\n";
+
+	std::remove(fileName);
+	return 0;
+}
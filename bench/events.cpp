@@ -0,0 +1,66 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sys/resource.h>
+
+/**
+ * @brief Forwards only the keys of one section, like a log shipper would.
+ */
+struct SelectingHandler : INIHandler {
+	std::size_t selected{ 0 };
+
+	bool onKeyValue(std::string_view section, std::string_view, std::string_view value, int) override {
+		if (section == "section_7") {
+			selected += value.length();
+		}
+
+		return true;
+	}
+};
+
+/**
+ * @returns The peak resident set size of the process in MiB.
+ */
+static double peakMiB() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+}
+
+int main() {
+	const char *fileName = "bench_events.ini";
+
+	GeneratorOptions options;
+	options.sections = 20000;
+	options.keysPerSection = 50;
+	generateConfig(fileName, options);
+
+	const double baseline = peakMiB();
+
+	// the event parser keeps nothing, so memory should not grow with the file
+	SelectingHandler handler;
+	auto start = std::chrono::steady_clock::now();
+	const ErrorCode error = INIParser(handler).parseFile(fileName);
+	auto end = std::chrono::steady_clock::now();
+
+	if (error != ErrorCode::None) {
+		std::cout << "failed to parse: " << errorStrings[static_cast<int>(error)] << '\n';
+		return 1;
+	}
+
+	std::cout << "events: " << std::chrono::duration<double, std::milli>(end - start).count()
+		<< " ms, peak memory +" << peakMiB() - baseline << " MiB\n";
+
+	start = std::chrono::steady_clock::now();
+	const INIReader reader(fileName);
+	end = std::chrono::steady_clock::now();
+
+	std::cout << "reader: " << std::chrono::duration<double, std::milli>(end - start).count()
+		<< " ms, peak memory +" << peakMiB() - baseline << " MiB\n";
+
+	std::remove(fileName);
+	return 0;
+}
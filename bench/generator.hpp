@@ -0,0 +1,123 @@
+#pragma once
+
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The type of value stored under a generated key.
+ */
+enum class ValueType {
+	String,
+	Int,
+	Double,
+	Bool
+};
+
+/**
+ * @brief Describes the shape of a generated configuration file.
+ */
+struct GeneratorOptions {
+	// Number of sections in the file.
+	int sections{ 1000 };
+
+	// Number of key-value pairs in each section.
+	int keysPerSection{ 20 };
+
+	// Length of generated string values.
+	int valueLength{ 24 };
+
+	// Chance (0 to 1) of a comment line before each key, and of an inline
+	// comment after each bare value.
+	double commentDensity{ 0.1 };
+
+	// Chance (0 to 1) of a string value being surrounded by double quotes.
+	double quotedFraction{ 0.5 };
+
+	// Seed for the random number generator, so files can be reproduced.
+	unsigned seed{ 42 };
+};
+
+/**
+ * @brief A key that was written to a generated file.
+ */
+struct GeneratedKey {
+	std::string section;
+	std::string key;
+	ValueType type;
+};
+
+/**
+ * @brief Writes a synthetic configuration file. Keys cycle through strings,
+ * integers, doubles and booleans so every getter has values to read.
+ * @param fileName The path of the file to write.
+ * @param options The shape of the file.
+ * @returns Every key that was written, in order.
+ */
+inline std::vector<GeneratedKey> generateConfig(const char *fileName, const GeneratorOptions &options) {
+	std::mt19937 rng(options.seed);
+	std::uniform_real_distribution<double> chance(0.0, 1.0);
+	std::uniform_int_distribution<int> letter('a', 'z');
+
+	std::vector<GeneratedKey> keys;
+	keys.reserve(static_cast<std::size_t>(options.sections) * options.keysPerSection);
+
+	std::ofstream file(fileName);
+	std::string value;
+
+	for (int s = 0; s < options.sections; ++s) {
+		const std::string section = "section_" + std::to_string(s);
+		file << '[' << section << "]\n";
+
+		for (int k = 0; k < options.keysPerSection; ++k) {
+			const ValueType type = static_cast<ValueType>(k % 4);
+			keys.push_back(GeneratedKey{ section, "key_" + std::to_string(k), type });
+
+			if (chance(rng) < options.commentDensity) {
+				file << "; comment describing " << keys.back().key << '\n';
+			}
+
+			bool quoted = false;
+			switch (type) {
+				case ValueType::String:
+					value.clear();
+					for (int i = 0; i < options.valueLength; ++i) {
+						value += static_cast<char>(letter(rng));
+					}
+					quoted = chance(rng) < options.quotedFraction;
+					break;
+				case ValueType::Int:
+					value = std::to_string(rng() % 100000);
+					break;
+				case ValueType::Double:
+					value = std::to_string(rng() % 1000) + '.' + std::to_string(rng() % 1000);
+					break;
+				case ValueType::Bool:
+					value = (rng() & 1) ? "true" : "off";
+					break;
+			}
+
+			file << keys.back().key << " = ";
+			if (quoted) {
+				file << '"' << value << '"';
+			} else {
+				file << value;
+
+				if (chance(rng) < options.commentDensity) {
+					file << " ; inline comment";
+				}
+			}
+			file << '\n';
+		}
+
+		file << '\n';
+	}
+
+	return keys;
+}
+
+#endif // !GENERATOR_HPP
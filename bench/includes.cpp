@@ -0,0 +1,79 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Returns the best time in milliseconds of loading the file `runs`
+ * times with the given mode and number of threads.
+ */
+static double bestLoadMs(const char *fileName, LoadMode mode, unsigned threads, int runs) {
+	double best = 0.0;
+
+	for (int r = 0; r < runs; ++r) {
+		const auto start = std::chrono::steady_clock::now();
+		INIReader reader(fileName, mode, threads);
+		const auto end = std::chrono::steady_clock::now();
+
+		if (!reader.success()) {
+			std::cout << "failed to parse: " << reader.getError() << '\n';
+			std::exit(1);
+		}
+
+		const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		best = (r == 0) ? ms : std::min(best, ms);
+	}
+
+	return best;
+}
+
+int main() {
+	const char *directory = "bench_includes";
+	const char *rootName = "bench_includes.ini";
+	const char *joinedName = "bench_includes_joined.ini";
+	const int fragments = 32;
+
+	std::filesystem::create_directory(directory);
+	std::ofstream joined(joinedName, std::ios::binary);
+
+	// the fragments are also joined into one file, as a shell script would
+	GeneratorOptions options;
+	options.sections = 500;
+
+	for (int i = 0; i < fragments; ++i) {
+		const std::string name = std::string(directory) + "/fragment_" + std::to_string(i) + ".ini";
+		options.seed = static_cast<unsigned>(i);
+		generateConfig(name.c_str(), options);
+		joined << std::ifstream(name, std::ios::binary).rdbuf();
+	}
+
+	joined.close();
+	std::ofstream(rootName) << "!include " << directory << "/*.ini\n";
+
+	const double single = bestLoadMs(joinedName, LoadMode::Mapped, 0, 5);
+	std::cout << fragments << " fragments joined into one file: " << single << " ms\n";
+
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned threads = 1; threads <= cores; threads *= 2) {
+		const double ms = bestLoadMs(rootName, LoadMode::Mapped, threads, 5);
+		std::cout << "included with " << threads << " threads: " << ms << " ms, speedup " << single / ms << "x\n";
+
+		// always finish on the number of cores, even when it is not a power of two
+		if (threads < cores && threads * 2 > cores) {
+			threads = cores / 2;
+		}
+	}
+
+	std::filesystem::remove_all(directory);
+	std::filesystem::remove(rootName);
+	std::filesystem::remove(joinedName);
+	return 0;
+}
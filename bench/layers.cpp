@@ -0,0 +1,97 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief Times `rounds` calls of `fn` and returns the cost per call in nanoseconds.
+ */
+template <typename Fn>
+static double nsPerCall(int rounds, Fn fn) {
+	long long checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int r = 0; r < rounds; ++r) {
+		checksum += fn(r);
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	// keep the work observable so it is not optimised away
+	if (checksum == 0) {
+		std::cout << "";
+	}
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+}
+
+/**
+ * @brief Writes a file that overrides the ints of every `every`th section.
+ */
+static void writeOverrides(const char *fileName, const std::vector<GeneratedKey> &keys, std::size_t every) {
+	std::ofstream file(fileName);
+	std::string section;
+
+	for (std::size_t i = 0; i < keys.size(); i += every) {
+		if (keys[i].type != ValueType::Int) {
+			continue;
+		}
+
+		if (keys[i].section != section) {
+			section = keys[i].section;
+			file << '[' << section << "]\n";
+		}
+
+		file << keys[i].key << " = " << i << '\n';
+	}
+}
+
+int main() {
+	const char *defaultsName = "bench_layers_defaults.ini";
+	const char *siteName = "bench_layers_site.ini";
+	const char *hostName = "bench_layers_host.ini";
+
+	const std::vector<GeneratedKey> keys = generateConfig(defaultsName, GeneratorOptions());
+	writeOverrides(siteName, keys, 4);
+	writeOverrides(hostName, keys, 64);
+
+	std::vector<const GeneratedKey *> ints;
+	for (const auto &key : keys) {
+		if (key.type == ValueType::Int) {
+			ints.push_back(&key);
+		}
+	}
+
+	const INIReader defaults(defaultsName);
+	const INIReader site(siteName);
+	const INIReader host(hostName);
+
+	const auto start = std::chrono::steady_clock::now();
+	const INIReader layered = INIReader::fromLayers({ defaults, site, host });
+	const auto end = std::chrono::steady_clock::now();
+
+	const int rounds = 5000000;
+
+	// the approach being replaced: ask each reader in turn, from the top down
+	const double chained = nsPerCall(rounds, [&](int r) {
+		const GeneratedKey *key = ints[r % ints.size()];
+		return host.getInt(key->section, key->key, site.getInt(key->section, key->key, defaults.getInt(key->section, key->key, 0)));
+	});
+
+	const double flattened = nsPerCall(rounds, [&](int r) {
+		const GeneratedKey *key = ints[r % ints.size()];
+		return layered.getInt(key->section, key->key, 0);
+	});
+
+	std::cout << "3 layers, " << keys.size() << " keys: built in " << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+	std::cout << "getInt: chained readers " << chained << " ns, layered reader " << flattened << " ns\n";
+
+	std::remove(defaultsName);
+	std::remove(siteName);
+	std::remove(hostName);
+	return 0;
+}
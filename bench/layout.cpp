@@ -0,0 +1,86 @@
+#include "../src/ini.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Returns the nanoseconds taken by `fn`.
+ */
+template <typename Fn>
+static double timeNs(Fn fn) {
+	const auto start = std::chrono::steady_clock::now();
+	fn();
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int main() {
+	const char *fileName = "bench_layout.ini";
+	const int keysPerSection = 10;
+
+	// compile with CXXFLAGS=-DUSE_FLAT_STORAGE=1 to compare layouts
+	std::cout << "layout: " << (USE_FLAT_STORAGE ? "flat sorted vectors" : "map/set") << '\n';
+
+	for (const int numKeys : { 10, 1000, 100000 }) {
+		std::vector<std::pair<std::string, std::string>> lookups;
+
+		std::ofstream file(fileName);
+		for (int s = 0; s < numKeys / keysPerSection; ++s) {
+			const std::string section = "section_" + std::to_string(s);
+			file << '[' << section << "]\n";
+
+			for (int k = 0; k < keysPerSection; ++k) {
+				lookups.emplace_back(section, "key_" + std::to_string(k));
+				file << lookups.back().second << " = " << s * k << '\n';
+			}
+		}
+		file.close();
+
+		INIReader reader(fileName);
+		if (!reader.success()) {
+			std::cout << "failed to parse: " << reader.getError() << '\n';
+			return 1;
+		}
+
+		std::shuffle(lookups.begin(), lookups.end(), std::mt19937(42));
+		const int rounds = std::max(1, 1000000 / numKeys);
+		std::size_t checksum = 0;
+
+		const double iterateNs = timeNs([&]() {
+			for (int r = 0; r < rounds; ++r) {
+				for (const auto &section : reader.getSectionNames()) {
+					for (const auto &field : reader.getSectionFields(section)) {
+						checksum += field.value.length();
+					}
+				}
+			}
+		});
+
+		const double lookupNs = timeNs([&]() {
+			for (int r = 0; r < rounds; ++r) {
+				for (const auto &lookup : lookups) {
+					checksum += reader.getStringView(lookup.first, lookup.second, "").length();
+				}
+			}
+		});
+
+		// keep the work observable so it is not optimised away
+		if (checksum == 0) {
+			std::cout << "";
+		}
+
+		const double perField = static_cast<double>(numKeys) * rounds;
+		std::cout << numKeys << " keys: iterate " << iterateNs / perField << " ns/field, lookup "
+			<< lookupNs / perField << " ns/key\n";
+	}
+
+	std::remove(fileName);
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include "../src/ini.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+/**
+ * @brief Number of heap allocations made since the program started.
+ */
+static std::size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+	++allocations;
+
+	if (void *ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+/**
+ * @brief Writes a configuration file with long keys and values so that
+ * copying them cannot benefit from the small string optimisation.
+ */
+static void writeConfig(const char *fileName, int sections, int keys) {
+	std::ofstream file(fileName);
+
+	for (int s = 0; s < sections; ++s) {
+		file << "[section_number_" << s << "]\n";
+
+		for (int k = 0; k < keys; ++k) {
+			file << "configuration_key_" << k << " = \"a reasonably long value " << k << "\"\n";
+		}
+
+		file << '\n';
+	}
+}
+
+/**
+ * @brief Loads the file `runs` times and reports wall time and allocations
+ * for loading, and wall time for destroying the reader.
+ */
+static void measure(const char *label, const char *fileName, LoadMode mode, int runs) {
+	double loadMs = 0.0;
+	double destroyMs = 0.0;
+	std::size_t allocs = 0;
+
+	for (int i = 0; i < runs; ++i) {
+		const std::size_t before = allocations;
+		const auto start = std::chrono::steady_clock::now();
+
+		INIReader *reader = new INIReader(fileName, mode);
+
+		const auto loaded = std::chrono::steady_clock::now();
+
+		if (!reader->success()) {
+			std::cout << "failed to parse: " << reader->getError() << '\n';
+			std::exit(1);
+		}
+
+		allocs += allocations - before;
+		delete reader;
+
+		const auto end = std::chrono::steady_clock::now();
+		loadMs += std::chrono::duration<double, std::milli>(loaded - start).count();
+		destroyMs += std::chrono::duration<double, std::milli>(end - loaded).count();
+	}
+
+	std::cout << label << loadMs / runs << " ms, " << allocs / runs << " allocations, destroyed in " << destroyMs / runs << " ms\n";
+}
+
+int main() {
+	const char *fileName = "bench_load.ini";
+	writeConfig(fileName, 2000, 50);
+
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	std::cout << "file size: " << file.tellg() / (1024.0 * 1024.0) << " MiB, 100000 keys\n";
+	file.close();
+
+	measure("stream: ", fileName, LoadMode::Stream, 5);
+	measure("mapped: ", fileName, LoadMode::Mapped, 5);
+
+	std::remove(fileName);
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "../src/ini.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The lookup `INIReader::get` used before the index was added, kept
+ * here as the baseline to compare against.
+ */
+static const std::string linearGet(
+	const std::map<std::string, std::set<Field>> &lookup,
+	const std::string &section,
+	const std::string &key,
+	const std::string &defValue
+) {
+	if (lookup.find(section) == lookup.end()) {
+		return defValue;
+	}
+
+	for (const auto &field : lookup.at(section)) {
+		if (field.key == key) {
+			return std::string(field.value);
+		}
+	}
+
+	return defValue;
+}
+
+/**
+ * @brief Times `fn` for every key and returns the cost per lookup in nanoseconds.
+ */
+template <typename Fn>
+static double nsPerLookup(const std::vector<std::string> &keys, int rounds, Fn fn) {
+	std::size_t checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int r = 0; r < rounds; ++r) {
+		for (const auto &key : keys) {
+			checksum += fn(key).length();
+		}
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	// keep the work observable so it is not optimised away
+	if (checksum == 0) {
+		std::cout << "";
+	}
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / (keys.size() * rounds);
+}
+
+int main() {
+	const char *fileName = "bench_lookup.ini";
+
+	for (const int numKeys : { 1, 100, 10000 }) {
+		std::vector<std::string> keys;
+
+		std::ofstream file(fileName);
+		file << "[FLAGS]\n";
+		for (int k = 0; k < numKeys; ++k) {
+			keys.push_back("feature_flag_" + std::to_string(k));
+			file << keys.back() << " = " << k % 2 << '\n';
+		}
+		file.close();
+
+		INIReader reader(fileName);
+		if (!reader.success()) {
+			std::cout << "failed to parse: " << reader.getError() << '\n';
+			return 1;
+		}
+
+		std::map<std::string, std::set<Field>> lookup;
+		const auto fields = reader.getSectionFields("FLAGS");
+		lookup["FLAGS"] = std::set<Field>(fields.begin(), fields.end());
+
+		// do roughly the same number of lookups for every section size
+		const int rounds = 1000000 / numKeys;
+		const std::string section = "FLAGS";
+
+		const double before = nsPerLookup(keys, rounds / (numKeys > 100 ? 100 : 1), [&](const std::string &key) {
+			return linearGet(lookup, section, key, "");
+		});
+
+		const double after = nsPerLookup(keys, rounds, [&](const std::string &key) {
+			return reader.getString(section, key, "");
+		});
+
+		const double view = nsPerLookup(keys, rounds, [&](const std::string &key) {
+			return reader.getStringView("FLAGS", key, "");
+		});
+
+		std::cout << numKeys << " keys: linear scan " << before << " ns, index " << after << " ns, index (view) " << view << " ns\n";
+	}
+
+	std::remove(fileName);
+	return 0;
+}
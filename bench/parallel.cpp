@@ -0,0 +1,67 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+/**
+ * @brief Returns the best time in milliseconds of loading the file `runs`
+ * times with the given mode and number of threads.
+ */
+static double bestLoadMs(const char *fileName, LoadMode mode, unsigned threads, int runs) {
+	double best = 0.0;
+
+	for (int r = 0; r < runs; ++r) {
+		const auto start = std::chrono::steady_clock::now();
+		INIReader reader(fileName, mode, threads);
+		const auto end = std::chrono::steady_clock::now();
+
+		if (!reader.success()) {
+			std::cout << "failed to parse: " << reader.getError() << '\n';
+			std::exit(1);
+		}
+
+		const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		best = (r == 0) ? ms : std::min(best, ms);
+	}
+
+	return best;
+}
+
+int main() {
+	const char *fileName = "bench_parallel.ini";
+
+	GeneratorOptions options;
+	options.sections = 20000;
+	options.keysPerSection = 20;
+	generateConfig(fileName, options);
+
+	std::size_t bytes = 0;
+	{
+		const MappedFile file(fileName);
+		bytes = file.data().length();
+	}
+
+	const double mib = bytes / (1024.0 * 1024.0);
+	const double mapped = bestLoadMs(fileName, LoadMode::Mapped, 0, 5);
+	std::cout << "file size: " << mib << " MiB, mapped (serial): " << mapped << " ms\n";
+
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned threads = 1; threads <= cores; threads *= 2) {
+		const double ms = bestLoadMs(fileName, LoadMode::Parallel, threads, 5);
+		std::cout << threads << " threads: " << ms << " ms, " << mib * 1e3 / ms << " MiB/s, speedup " << mapped / ms << "x\n";
+
+		// always finish on the number of cores, even when it is not a power of two
+		if (threads < cores && threads * 2 > cores) {
+			threads = cores / 2;
+		}
+	}
+
+	std::remove(fileName);
+	return 0;
+}
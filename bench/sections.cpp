@@ -0,0 +1,35 @@
+#include "../src/ini.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+int main() {
+	const char *fileName = "bench_sections.ini";
+
+	// with linear parsing the cost per section should stay flat as the
+	// number of sections grows
+	for (const int numSections : { 1000, 10000, 100000 }) {
+		std::ofstream file(fileName);
+		for (int s = 0; s < numSections; ++s) {
+			file << "[tenant_" << s << "]\nenabled = 1\n";
+		}
+		file.close();
+
+		const auto start = std::chrono::steady_clock::now();
+		INIReader reader(fileName);
+		const auto end = std::chrono::steady_clock::now();
+
+		if (!reader.success()) {
+			std::cout << "failed to parse: " << reader.getError() << '\n';
+			return 1;
+		}
+
+		const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		std::cout << numSections << " sections: " << ms << " ms (" << ms * 1e6 / numSections << " ns/section)\n";
+	}
+
+	std::remove(fileName);
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include "../src/ini.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+constexpr Setting<int> Width{ "WINDOW", "Width", 800 };
+constexpr Setting<int> Height{ "WINDOW", "Height", 600 };
+constexpr Setting<double> FieldOfView{ "GRAPHICS", "FOV", 90.0 };
+constexpr Setting<bool> VSync{ "GRAPHICS", "VSYNC", false };
+
+/**
+ * @brief Times `rounds` calls of `fn` and returns the cost per call in nanoseconds.
+ */
+template <typename Fn>
+static double nsPerCall(int rounds, Fn fn) {
+	double checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int r = 0; r < rounds; ++r) {
+		checksum += fn();
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	// keep the work observable so it is not optimised away
+	if (checksum == 0) {
+		std::cout << "";
+	}
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+}
+
+int main() {
+	const char *fileName = "bench_settings.ini";
+	std::ofstream file(fileName);
+	file << "[WINDOW]\nWidth = 1920\nHeight = 1080\n[GRAPHICS]\nFOV = 75.5\nVSYNC = on\n";
+	file.close();
+
+	const INIReader reader(fileName);
+	const SettingTable<Width, Height, FieldOfView, VSync> table(reader);
+	const int rounds = 10000000;
+
+	const double getters = nsPerCall(rounds, [&]() {
+		return reader.getInt("WINDOW", "Width", 800) + reader.getInt("WINDOW", "Height", 600)
+			+ reader.getDouble("GRAPHICS", "FOV", 90.0) + reader.getBool("GRAPHICS", "VSYNC", false);
+	});
+
+	const double descriptors = nsPerCall(rounds, [&]() {
+		return reader.get(Width) + reader.get(Height) + reader.get(FieldOfView) + reader.get(VSync);
+	});
+
+	const double resolved = nsPerCall(rounds, [&]() {
+		return table.get<Width>() + table.get<Height>() + table.get<FieldOfView>() + table.get<VSync>();
+	});
+
+	std::cout << "4 settings per call: getters " << getters << " ns, descriptors " << descriptors << " ns, setting table " << resolved << " ns\n";
+
+	std::remove(fileName);
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs `read` on `threads` threads for a fixed time while another
+ * thread publishes a new configuration every millisecond with `publish`.
+ * @returns The total number of reads per second.
+ */
+template <typename Read, typename Publish>
+static double readsPerSecond(unsigned threads, Read read, Publish publish) {
+	std::atomic<bool> stop{ false };
+	std::atomic<std::size_t> total{ 0 };
+	std::vector<std::thread> readers;
+
+	for (unsigned t = 0; t < threads; ++t) {
+		readers.emplace_back([&, t]() {
+			std::size_t reads = 0;
+			long long checksum = 0;
+
+			while (!stop.load(std::memory_order_relaxed)) {
+				for (int i = 0; i < 1000; ++i) {
+					checksum += read(t, i);
+				}
+				reads += 1000;
+			}
+
+			// keep the work observable so it is not optimised away
+			if (checksum == 0) {
+				std::cout << "";
+			}
+
+			total += reads;
+		});
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500)) {
+		publish();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	stop = true;
+
+	for (auto &reader : readers) {
+		reader.join();
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+	return total / std::chrono::duration<double>(end - start).count();
+}
+
+int main() {
+	const char *fileName = "bench_snapshot.ini";
+	GeneratorOptions options;
+	options.sections = 100;
+	const std::vector<GeneratedKey> keys = generateConfig(fileName, options);
+
+	std::vector<const GeneratedKey *> ints;
+	for (const auto &key : keys) {
+		if (key.type == ValueType::Int) {
+			ints.push_back(&key);
+		}
+	}
+
+	const auto config = std::make_shared<const INIReader>(fileName);
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned threads = 1; threads <= cores; threads *= 2) {
+		// the approach being replaced: every read takes a lock to copy the pointer
+		std::mutex mutex;
+		std::shared_ptr<const INIReader> guarded = config;
+
+		const double locked = readsPerSecond(threads, [&](unsigned, int i) {
+			const GeneratedKey *key = ints[i % ints.size()];
+			std::lock_guard<std::mutex> lock(mutex);
+			return guarded->getInt(key->section, key->key, 0);
+		}, [&]() {
+			std::lock_guard<std::mutex> lock(mutex);
+			guarded = config;
+		});
+
+		// one handle per thread, which never touches shared memory until a publish
+		INIHolder holder(config);
+		std::vector<std::unique_ptr<INIHolder::Handle>> handles;
+		for (unsigned t = 0; t < threads; ++t) {
+			handles.push_back(std::make_unique<INIHolder::Handle>(holder));
+		}
+
+		const double snapshots = readsPerSecond(threads, [&](unsigned t, int i) {
+			const GeneratedKey *key = ints[i % ints.size()];
+			return handles[t]->get().getInt(key->section, key->key, 0);
+		}, [&]() {
+			holder.publish(config);
+		});
+
+		std::cout << threads << " threads: mutex " << locked / 1e6 << " M reads/s, snapshot handles " << snapshots / 1e6 << " M reads/s\n";
+
+		// always finish on the number of cores, even when it is not a power of two
+		if (threads < cores && threads * 2 > cores) {
+			threads = cores / 2;
+		}
+	}
+
+	std::remove(fileName);
+	return 0;
+}
@@ -0,0 +1,177 @@
+#include "../src/ini.hpp"
+#include "generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Prints how to run the suite.
+ */
+static void usage(const char *program) {
+	std::cerr << "usage: " << program << " [options]\n"
+		<< "  --sections N       number of sections (default 1000)\n"
+		<< "  --keys N           keys per section (default 20)\n"
+		<< "  --value-length N   length of string values (default 24)\n"
+		<< "  --comments P       chance of a comment per key, 0 to 1 (default 0.1)\n"
+		<< "  --quoted P         chance of a string value being quoted, 0 to 1 (default 0.5)\n"
+		<< "  --runs N           number of times to load the file (default 5)\n"
+		<< "  --lookups N        number of calls per getter (default 1000000)\n";
+}
+
+/**
+ * @brief Prints one result as a line of JSON.
+ */
+static void report(const std::string &name, const std::string &fields) {
+	std::cout << "{\"benchmark\":\"" << name << "\","
+		<< "\"arena\":" << USE_ARENA_STORAGE << ','
+		<< "\"flat\":" << USE_FLAT_STORAGE << ','
+		<< fields << "}\n";
+}
+
+/**
+ * @brief Returns the seconds taken by `fn`.
+ */
+template <typename Fn>
+static double timeSeconds(Fn fn) {
+	const auto start = std::chrono::steady_clock::now();
+	fn();
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - start).count();
+}
+
+/**
+ * @brief Times `lookups` calls of `fn` on keys of the given type and reports
+ * the latency per call.
+ */
+template <typename Fn>
+static void benchGetter(
+	const std::string &name,
+	const std::vector<GeneratedKey> &keys,
+	ValueType type,
+	std::size_t lookups,
+	Fn fn
+) {
+	std::vector<const GeneratedKey *> typed;
+	for (const auto &key : keys) {
+		if (key.type == type) {
+			typed.push_back(&key);
+		}
+	}
+
+	if (typed.empty()) {
+		return;
+	}
+
+	std::shuffle(typed.begin(), typed.end(), std::mt19937(7));
+
+	double checksum = 0;
+	const double seconds = timeSeconds([&]() {
+		for (std::size_t i = 0; i < lookups; ++i) {
+			const GeneratedKey *key = typed[i % typed.size()];
+			checksum += fn(key->section, key->key);
+		}
+	});
+
+	report(name, "\"calls\":" + std::to_string(lookups)
+		+ ",\"ns_per_call\":" + std::to_string(seconds * 1e9 / lookups)
+		+ ",\"checksum\":" + std::to_string(checksum));
+}
+
+int main(int argc, char **argv) {
+	GeneratorOptions options;
+	int runs = 5;
+	std::size_t lookups = 1000000;
+
+	for (int i = 1; i < argc; ++i) {
+		const bool hasValue = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--sections") == 0 && hasValue) {
+			options.sections = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--keys") == 0 && hasValue) {
+			options.keysPerSection = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--value-length") == 0 && hasValue) {
+			options.valueLength = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--comments") == 0 && hasValue) {
+			options.commentDensity = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--quoted") == 0 && hasValue) {
+			options.quotedFraction = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--runs") == 0 && hasValue) {
+			runs = std::max(1, std::atoi(argv[++i]));
+		} else if (std::strcmp(argv[i], "--lookups") == 0 && hasValue) {
+			lookups = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	const char *fileName = "bench_suite.ini";
+	const std::vector<GeneratedKey> keys = generateConfig(fileName, options);
+
+	std::size_t bytes = 0;
+	{
+		const MappedFile file(fileName);
+		bytes = file.data().length();
+	}
+
+	const std::string shape = "\"sections\":" + std::to_string(options.sections)
+		+ ",\"keys\":" + std::to_string(keys.size())
+		+ ",\"bytes\":" + std::to_string(bytes);
+
+	for (const LoadMode mode : { LoadMode::Stream, LoadMode::Mapped }) {
+		double best = 0.0;
+		double total = 0.0;
+
+		for (int r = 0; r < runs; ++r) {
+			// the reader is destroyed after the clock stops, so only construction is timed
+			std::unique_ptr<INIReader> reader;
+			const double seconds = timeSeconds([&]() {
+				reader = std::make_unique<INIReader>(fileName, mode);
+			});
+
+			if (!reader->success()) {
+				std::cerr << "failed to parse generated file\n";
+				std::remove(fileName);
+				return 1;
+			}
+
+			best = (r == 0) ? seconds : std::min(best, seconds);
+			total += seconds;
+		}
+
+		report(mode == LoadMode::Mapped ? "construct_mapped" : "construct_stream", shape
+			+ ",\"runs\":" + std::to_string(runs)
+			+ ",\"mean_ms\":" + std::to_string(total * 1e3 / runs)
+			+ ",\"best_ms\":" + std::to_string(best * 1e3)
+			+ ",\"mib_per_s\":" + std::to_string(bytes / (1024.0 * 1024.0) / best));
+	}
+
+	const INIReader reader(fileName);
+
+	benchGetter("getString", keys, ValueType::String, lookups, [&](const std::string &section, const std::string &key) {
+		return static_cast<double>(reader.getString(section, key, "").length());
+	});
+	benchGetter("getStringView", keys, ValueType::String, lookups, [&](const std::string &section, const std::string &key) {
+		return static_cast<double>(reader.getStringView(section, key, "").length());
+	});
+	benchGetter("getInt", keys, ValueType::Int, lookups, [&](const std::string &section, const std::string &key) {
+		return static_cast<double>(reader.getInt(section, key, 0));
+	});
+	benchGetter("getDouble", keys, ValueType::Double, lookups, [&](const std::string &section, const std::string &key) {
+		return reader.getDouble(section, key, 0.0);
+	});
+	benchGetter("getBool", keys, ValueType::Bool, lookups, [&](const std::string &section, const std::string &key) {
+		return reader.getBool(section, key, false) ? 1.0 : 0.0;
+	});
+
+	std::remove(fileName);
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include "../src/ini.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The regex-based `rstrip` that `INIReader` used previously, kept
+ * here as the baseline to compare against.
+ */
+static void regexRstrip(std::string &str) {
+	str = std::regex_replace(str, std::regex(" +$"), "");
+}
+
+/**
+ * @brief The regex-based `trim` that `INIReader` used previously.
+ */
+static void regexTrim(std::string &str) {
+	str = std::regex_replace(str, std::regex("^ +"), "");
+	regexRstrip(str);
+}
+
+/**
+ * @brief Times `fn` over every line and returns the cost per line in nanoseconds.
+ */
+template <typename Fn>
+static double nsPerLine(const std::vector<std::string> &lines, Fn fn) {
+	const auto start = std::chrono::steady_clock::now();
+	std::size_t checksum = 0;
+
+	for (const auto &line : lines) {
+		checksum += fn(line);
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+	const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+	// keep the work observable so it is not optimised away
+	if (checksum == 0) {
+		std::cout << "";
+	}
+
+	return ns / lines.size();
+}
+
+int main() {
+	const std::size_t numLines = 40000;
+
+	// lines shaped like the ones the constructor sees: a line is right-stripped,
+	// then the key and the value are each trimmed
+	std::vector<std::string> lines;
+	lines.reserve(numLines);
+	for (std::size_t i = 0; i < numLines; ++i) {
+		lines.push_back("  key_" + std::to_string(i) + "   =   value number " + std::to_string(i) + "    ");
+	}
+
+	const double before = nsPerLine(lines, [](const std::string &line) {
+		std::string copy = line;
+		regexRstrip(copy);
+
+		const std::size_t idx = copy.find('=');
+		std::string key = copy.substr(0, idx);
+		std::string val = copy.substr(idx + 1);
+		regexTrim(key);
+		regexTrim(val);
+		return key.length() + val.length();
+	});
+
+	const double after = nsPerLine(lines, [](const std::string &line) {
+		const std::string_view view = INIReader::rstrip(line);
+
+		const std::size_t idx = view.find('=');
+		const std::string_view key = INIReader::trim(view.substr(0, idx));
+		const std::string_view val = INIReader::trim(view.substr(idx + 1));
+		return key.length() + val.length();
+	});
+
+	std::cout << "lines: " << numLines << '\n';
+	std::cout << "regex trim:       " << before << " ns/line\n";
+	std::cout << "string_view trim: " << after << " ns/line\n";
+	std::cout << "speedup:          " << before / after << "x\n";
+
+	return 0;
+}
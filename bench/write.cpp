@@ -0,0 +1,113 @@
+#include "../src/ini.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Writes a synthetic configuration of about `bytes` bytes, one field
+ * at a time, with `writeSection` and `writeField`.
+ */
+template <typename WriteSection, typename WriteField>
+static void generate(std::size_t bytes, WriteSection writeSection, WriteField writeField) {
+	// names are made up front so that the benchmark measures the writing
+	std::vector<std::string> keys;
+	for (int k = 0; k < 20; ++k) {
+		keys.push_back("key_" + std::to_string(k));
+	}
+
+	char name[32] = "section_";
+	std::size_t total = 0;
+
+	for (int s = 0; total < bytes; ++s) {
+		const auto end = std::to_chars(name + 8, name + sizeof(name), s).ptr;
+		writeSection(std::string_view(name, static_cast<std::size_t>(end - name)));
+		total += static_cast<std::size_t>(end - name) + 3;
+
+		for (std::size_t k = 0; k < keys.size(); ++k) {
+			const std::string_view value = (k % 2 == 0) ? "a value that has ; a comment prefix" : "8080";
+			writeField(keys[k], value);
+			total += keys[k].length() + value.length() + 4;
+		}
+	}
+}
+
+/**
+ * @brief Runs `write` and prints the throughput of writing `bytes` bytes.
+ */
+template <typename Write>
+static void measure(const char *label, std::size_t bytes, Write write) {
+	const auto start = std::chrono::steady_clock::now();
+	write();
+	const auto end = std::chrono::steady_clock::now();
+
+	const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+	std::cout << label << ms << " ms, " << bytes / (1024.0 * 1024.0) * 1e3 / ms << " MiB/s\n";
+}
+
+int main(int argc, char **argv) {
+	const char *fileName = "bench_write.ini";
+	const std::size_t bytes = static_cast<std::size_t>(argc > 1 ? std::atoi(argv[1]) : 256) * 1024 * 1024;
+
+	// the text itself, so every sink writes the same amount
+	std::string text;
+	measure("string sink: ", bytes, [&]() {
+		INIWriter writer(text);
+		generate(bytes, [&](std::string_view name) { writer.section(name); }, [&](std::string_view key, std::string_view value) { writer.field(key, value); });
+	});
+
+	// the fastest the disk can take the same text, written in one call
+	measure("single write of the text: ", text.length(), [&]() {
+		std::ofstream file(fileName, std::ios::binary);
+		file.write(text.data(), static_cast<std::streamsize>(text.length()));
+	});
+
+	// what had to be done before: build a field and format it with `toString`
+	measure("ofstream and Field::toString: ", text.length(), [&]() {
+		std::ofstream file(fileName, std::ios::binary);
+		generate(bytes, [&](std::string_view name) { file << '[' << name << "]\n"; }, [&](std::string_view key, std::string_view value) {
+			Field field;
+			field.key = key;
+			field.value = value;
+			file << field.toString() << '\n';
+		});
+	});
+
+	measure("ofstream sink: ", text.length(), [&]() {
+		std::ofstream file(fileName, std::ios::binary);
+		INIWriter writer(file);
+		generate(bytes, [&](std::string_view name) { writer.section(name); }, [&](std::string_view key, std::string_view value) { writer.field(key, value); });
+		writer.commit();
+	});
+
+	measure("file descriptor sink: ", text.length(), [&]() {
+		const int fd = ::open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		{
+			INIWriter writer(fd);
+			generate(bytes, [&](std::string_view name) { writer.section(name); }, [&](std::string_view key, std::string_view value) { writer.field(key, value); });
+			writer.commit();
+		}
+		::close(fd);
+	});
+
+	// includes making the file durable before it is renamed into place
+	measure("atomic file replacement (with fsync): ", text.length(), [&]() {
+		INIWriter writer(fileName);
+		generate(bytes, [&](std::string_view name) { writer.section(name); }, [&](std::string_view key, std::string_view value) { writer.field(key, value); });
+		writer.commit();
+	});
+
+	if (INIReader(fileName, LoadMode::Mapped).getStringView("section_0", "key_0", "") != "a value that has ; a comment prefix") {
+		std::cout << "written file does not read back\n";
+		return 1;
+	}
+
+	std::remove(fileName);
+	return 0;
+}
@@ -1,5 +1,5 @@
 #!/bin/bash
 
-g++ test/main.cpp src/ini.cpp -o main
+g++ -std=c++17 -pthread test/main.cpp src/ini.cpp -o main
 ./main
 rm main
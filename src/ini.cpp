@@ -2,310 +2,3336 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
-#include <regex>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#	include <cerrno>
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	define HAS_MMAP 1
+#else
+#	define HAS_MMAP 0
+#endif
+
+#if defined(__linux__)
+#	include <cerrno>
+#	include <poll.h>
+#	include <sys/eventfd.h>
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#	define HAS_INOTIFY 1
+#else
+#	define HAS_INOTIFY 0
+#endif
+
+#if USE_SIMD_SCAN && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__))
+#	include <immintrin.h>
+#	define HAS_SSE2 1
+#else
+#	define HAS_SSE2 0
+#endif
+
+// AVX2 is only used when the processor supports it, which is checked at runtime
+#if HAS_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#	define HAS_AVX2 1
+#else
+#	define HAS_AVX2 0
+#endif
+
+#if COLLECT_LOAD_STATS
+/**
+ * @brief Adds the time between its creation and its destruction to a total.
+ */
+class PhaseTimer {
+
+private:
+
+	std::chrono::nanoseconds &m_total;
+	const std::chrono::steady_clock::time_point m_start{ std::chrono::steady_clock::now() };
+
+public:
+
+	explicit PhaseTimer(std::chrono::nanoseconds &total) : m_total(total) {}
+
+	~PhaseTimer() {
+		m_total += std::chrono::steady_clock::now() - m_start;
+	}
+
+};
+
+// times the rest of the enclosing scope, and adds to a count
+#	define TIME_PHASE(total) const PhaseTimer phaseTimer(total)
+#	define COUNT_STAT(count, n) ((count) += (n))
+
+// times a whole load, from the start of a function to its contents being finished
+#	define START_LOAD() const auto loadStart = std::chrono::steady_clock::now()
+#	define FINISH_LOAD(contents) (contents).finishStats(loadStart)
+#else
+#	define TIME_PHASE(total)
+#	define COUNT_STAT(count, n)
+#	define START_LOAD()
+#	define FINISH_LOAD(contents)
+#endif
+
+/**
+ * @returns `true` if `c` is an ASCII whitespace character, `false` otherwise.
+ */
+static inline bool isWhitespace(const char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+
+MappedFile::MappedFile(const char *fileName) {
+#if HAS_MMAP
+	const int fd = ::open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+
+	// only regular files have a size that can be mapped; pipes and devices
+	// would give an empty or partial mapping
+	struct stat info;
+	if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+		::close(fd);
+		return;
+	}
+
+	m_size = static_cast<std::size_t>(info.st_size);
+	m_open = true;
+
+	// mapping an empty file is an error, so leave the contents empty
+	if (m_size > 0) {
+		void *addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		// a file truncated between the two calls would fault when the end
+		// of the mapping is read, so check its size again
+		struct stat mapped;
+		if (addr != MAP_FAILED && (::fstat(fd, &mapped) != 0 || static_cast<std::size_t>(mapped.st_size) != m_size)) {
+			::munmap(addr, m_size);
+			addr = MAP_FAILED;
+		}
+
+		if (addr == MAP_FAILED) {
+			m_size = 0;
+			m_open = false;
+		} else {
+			m_data = static_cast<const char *>(addr);
+			m_mapped = true;
+		}
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+#else
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	if (file.fail()) {
+		return;
+	}
+
+	m_size = static_cast<std::size_t>(file.tellg());
+	m_open = true;
+
+	if (m_size > 0) {
+		char *buffer = new char[m_size];
+		file.seekg(0);
+		file.read(buffer, m_size);
+		m_data = buffer;
+	}
+#endif
+}
+
+
+MappedFile::~MappedFile() {
+#if HAS_MMAP
+	if (m_mapped) {
+		::munmap(const_cast<char *>(m_data), m_size);
+		return;
+	}
+#endif
+	delete[] m_data;
+}
+
+
+void FieldIndex::rehash(const std::size_t slots) {
+	std::vector<Slot> old(slots);
+	old.swap(m_slots);
 
-void INIReader::lstrip(std::string &str) {
-	str = std::regex_replace(str, std::regex("^ +"), "");
+	for (const Slot &slot : old) {
+		if (!slot.field) {
+			continue;
+		}
+
+		std::size_t idx = home(slot.hash);
+		while (m_slots[idx].field) {
+			idx = (idx + 1) & (m_slots.size() - 1);
+		}
+
+		m_slots[idx] = slot;
+	}
+}
+
+
+void FieldIndex::reserve(const std::size_t count) {
+	std::size_t slots = 16;
+	while (slots < count * 2) {
+		slots *= 2;
+	}
+
+	if (slots > m_slots.size()) {
+		rehash(slots);
+	}
 }
 
 
-void INIReader::rstrip(std::string &str) {
-	str = std::regex_replace(str, std::regex(" +$"), "");
+bool FieldIndex::insert(std::string_view section, const Field *field, const std::uint64_t h) {
+	// keep the table at most half full so that probe sequences stay short
+	if ((m_size + 1) * 2 > m_slots.size()) {
+		rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+	}
+
+	std::size_t idx = home(h);
+
+	while (m_slots[idx].field) {
+		const Slot &slot = m_slots[idx];
+
+		// key already exists in section
+		if (slot.hash == h && slot.section == section && slot.field->key == field->key) {
+			return false;
+		}
+
+		idx = (idx + 1) & (m_slots.size() - 1);
+	}
+
+	m_slots[idx] = Slot{ h, section, field };
+	++m_size;
+	return true;
 }
 
 
-void INIReader::trim(std::string &str) {
-	lstrip(str);
-	rstrip(str);
+const Field *FieldIndex::find(std::string_view section, std::string_view key, std::uint64_t hash) const {
+	if (m_slots.empty()) {
+		return nullptr;
+	}
+
+	std::size_t idx = home(hash);
+
+	while (m_slots[idx].field) {
+		const Slot &slot = m_slots[idx];
+
+		if (slot.hash == hash && slot.section == section && slot.field->key == key) {
+			return slot.field;
+		}
+
+		idx = (idx + 1) & (m_slots.size() - 1);
+	}
+
+	return nullptr;
 }
 
 
-bool INIReader::hasEmptySections() {
-	// no empty sections if map is empty
-	if (m_lookup.empty()) {
+/**
+ * @returns `true` if `str` matches the lowercase string `lower`, ignoring
+ * case, `false` otherwise.
+ */
+static bool equalsIgnoreCase(std::string_view str, std::string_view lower) {
+	if (str.length() != lower.length()) {
 		return false;
 	}
 
-	// check if each section has at least one key-value pair
-	for (const auto &entry : m_lookup) {
-		if (entry.second.empty()) {
-			return true;
+	for (std::size_t i = 0; i < str.length(); ++i) {
+		if (std::tolower(static_cast<unsigned char>(str[i])) != lower[i]) {
+			return false;
 		}
 	}
 
+	return true;
+}
+
+
+std::string_view INIReader::lstrip(std::string_view str) {
+	std::size_t start = 0;
+	while (start < str.length() && isWhitespace(str[start])) {
+		++start;
+	}
+
+	str.remove_prefix(start);
+	return str;
+}
+
+
+std::string_view INIReader::rstrip(std::string_view str) {
+	std::size_t end = str.length();
+	while (end > 0 && isWhitespace(str[end - 1])) {
+		--end;
+	}
+
+	str.remove_suffix(str.length() - end);
+	return str;
+}
+
+
+std::string_view INIReader::trim(std::string_view str) {
+	return rstrip(lstrip(str));
+}
+
+
+bool INIParser::fail(const ErrorCode error) {
+	m_error = error;
+	m_handler.onError(error, m_line_num);
 	return false;
 }
 
 
-void INIReader::removeComment(std::string &str) {
-	const std::string s(START_COMMENT_PREFIXES);
-	char commentChar;
-	std::size_t commentIdx;
+/**
+ * @returns The position of the lowest set bit in `mask`, which must not be 0.
+ */
+static inline unsigned lowestBit(const std::uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+	unsigned bit = 0;
+	while (!(mask & (std::uint64_t{ 1 } << bit))) {
+		++bit;
+	}
+	return bit;
+#endif
+}
+
+
+/**
+ * @brief Lookup tables for the characters the parser needs to find in a line
+ * (newlines, '=', ']', '"' and the comment prefixes).
+ */
+struct MarkTables {
+	// Whether each character is marked.
+	bool marked[256];
 
-	bool commentFound{ false };
-	for (const auto &c : s) {
-		commentIdx = str.find(c);
+	// Bit `k % 8` is set in the entries for the low and high nibbles of the
+	// `k`-th marked character, so a character is (almost certainly) marked
+	// when the entries for both of its nibbles share a bit.
+	std::uint8_t low[16];
+	std::uint8_t high[16];
+};
 
-		if (commentIdx != std::string::npos) {
-			commentFound = true;
-			commentChar = c;
-			break;
+
+static constexpr MarkTables makeMarkTables() {
+	MarkTables tables{};
+	const char chars[] = "\n=]\"" START_COMMENT_PREFIXES;
+
+	for (std::size_t k = 0; k + 1 < sizeof(chars); ++k) {
+		const auto c = static_cast<unsigned char>(chars[k]);
+		tables.marked[c] = true;
+		tables.low[c & 0x0f] |= static_cast<std::uint8_t>(1 << (k % 8));
+		tables.high[c >> 4] |= static_cast<std::uint8_t>(1 << (k % 8));
+	}
+
+	return tables;
+}
+
+
+static constexpr MarkTables markTables = makeMarkTables();
+
+
+/**
+ * @returns `true` if the parser needs to know where `c` appears in a line.
+ */
+static inline bool isMarked(const char c) {
+	return markTables.marked[static_cast<unsigned char>(c)];
+}
+
+
+#if !HAS_SSE2
+/**
+ * @brief Classifies blocks of 64 bytes one byte at a time, for processors
+ * without SIMD.
+ */
+static void classifyScalar(const char *data, const std::size_t blocks, std::uint64_t *masks) {
+	for (std::size_t b = 0; b < blocks; ++b) {
+		std::uint64_t mask = 0;
+
+		for (unsigned i = 0; i < 64; ++i) {
+			mask |= static_cast<std::uint64_t>(isMarked(data[64 * b + i])) << i;
 		}
+
+		masks[b] = mask;
 	}
+}
+#endif
+
+
+#if HAS_SSE2
+/**
+ * @brief Classifies blocks of 64 bytes 16 bytes at a time using SSE2, which
+ * every 64-bit x86 processor supports.
+ */
+static void classifySSE2(const char *data, const std::size_t blocks, std::uint64_t *masks) {
+	const std::string_view prefixes(START_COMMENT_PREFIXES);
+
+	for (std::size_t b = 0; b < blocks; ++b) {
+		// the walk over the text is faster than memory, so fetch a page ahead
+		_mm_prefetch(data + 64 * b + 4096, _MM_HINT_T0);
+		std::uint64_t mask = 0;
+
+		for (unsigned i = 0; i < 4; ++i) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 64 * b + 16 * i));
+			__m128i marked = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('='))),
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(']')), _mm_cmpeq_epi8(v, _mm_set1_epi8('"')))
+			);
+
+			for (const char prefix : prefixes) {
+				marked = _mm_or_si128(marked, _mm_cmpeq_epi8(v, _mm_set1_epi8(prefix)));
+			}
+
+			mask |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(marked))) << (16 * i);
+		}
 
-	// no comment in string
-	if (!commentFound) {
-		return;
+		masks[b] = mask;
+	}
+}
+#endif
+
+
+#if HAS_AVX2
+/**
+ * @brief Classifies blocks of 64 bytes 32 bytes at a time using AVX2, looking
+ * up both nibbles of every byte in `markTables` instead of comparing against
+ * each marked character.
+ */
+__attribute__((target("avx2")))
+static void classifyAVX2(const char *data, const std::size_t blocks, std::uint64_t *masks) {
+	const __m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(markTables.low)));
+	const __m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(markTables.high)));
+	const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+	for (std::size_t b = 0; b < blocks; ++b) {
+		// the walk over the text is faster than memory, so fetch a page ahead
+		_mm_prefetch(data + 64 * b + 4096, _MM_HINT_T0);
+		std::uint64_t mask = 0;
+
+		for (unsigned i = 0; i < 2; ++i) {
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 64 * b + 32 * i));
+			const __m256i bits = _mm256_and_si256(
+				_mm256_shuffle_epi8(low, _mm256_and_si256(v, nibble)),
+				_mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble))
+			);
+			const __m256i unmarked = _mm256_cmpeq_epi8(bits, _mm256_setzero_si256());
+
+			mask |= static_cast<std::uint64_t>(~static_cast<std::uint32_t>(_mm256_movemask_epi8(unmarked))) << (32 * i);
+		}
+
+		masks[b] = mask;
+	}
+}
+#endif
+
+
+/**
+ * @brief Classifies blocks of 64 bytes with the fastest kernel the processor
+ * supports, which is chosen the first time this is called.
+ * @param data The blocks to classify.
+ * @param blocks The number of blocks.
+ * @param masks Set to one mask per block, where bit `i` is set when byte `i`
+ * of the block is marked. Characters that are not marked may occasionally be
+ * set too, so callers should check the character itself.
+ */
+static void classifyBlocks(const char *data, const std::size_t blocks, std::uint64_t *masks) {
+	using Classifier = void (*)(const char *, std::size_t, std::uint64_t *);
+
+	static const Classifier classifier = []() -> Classifier {
+#if HAS_AVX2
+		if (__builtin_cpu_supports("avx2")) {
+			return classifyAVX2;
+		}
+#endif
+#if HAS_SSE2
+		return classifySSE2;
+#else
+		return classifyScalar;
+#endif
+	}();
+
+	classifier(data, blocks, masks);
+}
+
+
+/**
+ * @brief Records where a marked character appears in a line.
+ * @param marks The positions found so far in the line.
+ * @param c The marked character, which is not a newline.
+ * @param pos The position of `c` in the line.
+ */
+static inline void mark(LineMarks &marks, const char c, const std::size_t pos) {
+	const std::string_view prefixes(START_COMMENT_PREFIXES);
+
+	if (c == '=') {
+		if (marks.equals == LineMarks::npos) {
+			marks.equals = pos;
+		}
+	} else if (c == ']') {
+		if (marks.close == LineMarks::npos) {
+			marks.close = pos;
+		}
+	} else if (c == '"') {
+		marks.lastQuote = pos;
+	} else if (marks.equals != LineMarks::npos) {
+		// comment prefixes only matter in values
+		const std::size_t k = prefixes.find(c);
+		if (k != std::string_view::npos && marks.comments[k] == LineMarks::npos) {
+			marks.comments[k] = pos;
+		}
+	}
+}
+
+
+/**
+ * @brief Finds the positions the parser needs in a single line, one byte at
+ * a time. Used for lines that are not scanned in blocks.
+ */
+static LineMarks markLine(std::string_view str) {
+	LineMarks marks;
+
+	for (std::size_t i = 0; i < str.length(); ++i) {
+		if (isMarked(str[i])) {
+			mark(marks, str[i], i);
+		}
+	}
+
+	return marks;
+}
+
+
+bool INIParser::removeComment(std::string_view &str, std::string_view &comment, const LineMarks &marks, const std::size_t offset) const {
+	// the first prefix that appears decides where the comment starts
+	for (const std::size_t commentIdx : marks.comments) {
+		if (commentIdx == LineMarks::npos || commentIdx < offset) {
+			continue;
+		}
+
+		comment = str.substr(commentIdx - offset + 1);
+		str = INIReader::rstrip(str.substr(0, commentIdx - offset));
+		return true;
 	}
 
-	// found comment
-	str = str.substr(0, commentIdx);
-	rstrip(str);
+	// no comment in string
+	return false;
 }
 
 
-bool INIReader::parseSection(const std::string &str) {
+bool INIParser::parseSection(std::string_view str, const std::size_t closingIdx) {
 	// before parsing each section, check that at least one key-value pair is
 	// found in the previous section
-	if (hasEmptySections()) {
-		m_error = ErrorCode::EmptySection;
-		return false;
+	if (m_in_section && m_section_empty) {
+		return fail(ErrorCode::EmptySection);
 	}
 
 	m_in_section = true;
-	std::size_t closingIdx = str.find(']');
+	m_section_empty = true;
 
 	// could not find closing square bracket
-	if (closingIdx == std::string::npos) {
-		m_error = ErrorCode::NoClosingBracketForSection;
-		return false;
+	if (closingIdx == std::string_view::npos) {
+		return fail(ErrorCode::NoClosingBracketForSection);
 	}
 
 	// get name of section, removing any trailing whitespace inside section declaration
-	std::string sec = str.substr(1, closingIdx - 1);
-	rstrip(sec);
-	m_curr_section = sec;
+	const std::string_view name = INIReader::rstrip(str.substr(1, closingIdx - 1));
+	m_curr_section.assign(name);
 
-	// add section to names of sections
-	m_section_names.insert(sec);
-	return true;
+	COUNT_STAT(m_stats.sections, 1);
+	TIME_PHASE(m_stats.handling);
+	return m_handler.onSection(name, m_line_num);
 }
 
 
-bool INIReader::parsePair(const std::string &k, const std::string &v) {
+bool INIParser::parsePair(std::string_view str, const LineMarks &marks) {
 	// no key-value pair allowed outside section
 	if (!m_in_section) {
-		m_error = ErrorCode::KeyOutsideSection;
-		return false;
+		return fail(ErrorCode::KeyOutsideSection);
 	}
 
-	// copy initialize to not affect original string
-	std::string key = k;
-	std::string val = v;
-
 	// strip all whitespace
-	trim(key);
-	trim(val);
+	std::string_view key;
+	std::string_view val;
+	{
+		TIME_PHASE(m_stats.trimming);
+		key = INIReader::trim(str.substr(0, marks.equals));
+		val = INIReader::trim(str.substr(marks.equals + 1));
+	}
+	std::string_view comment;
+	bool hasComment{ false };
 
 	if (val.empty()) {
-		m_error = ErrorCode::NoValueForKey;
-		return false;
+		return fail(ErrorCode::NoValueForKey);
 	}
 
+	// position of the value in the line
+	const std::size_t offset = static_cast<std::size_t>(val.data() - str.data());
+
 	// value is a string
 	if (val.at(0) == '"') {
-		const std::size_t endIdx = val.rfind('"');
-
-		if (endIdx == std::string::npos || endIdx == 0) {
-			m_error = ErrorCode::NoClosingQuotationForValue;
-			return false;
+		// the last quote in the line is the closing one, unless it is the opening one
+		if (marks.lastQuote == offset) {
+			return fail(ErrorCode::NoClosingQuotationForValue);
 		}
 
-		val = val.substr(1, endIdx - 1);
-		rstrip(val);
+		val = INIReader::rstrip(val.substr(1, marks.lastQuote - offset - 1));
 	} else {
-		removeComment(val);
+		hasComment = removeComment(val, comment, marks, offset);
+	}
+
+	m_section_empty = false;
+
+	COUNT_STAT(m_stats.fields, 1);
+	COUNT_STAT(m_stats.comments, hasComment);
+	TIME_PHASE(m_stats.handling);
+
+	if (!m_handler.onKeyValue(m_curr_section, key, val, m_line_num)) {
+		return false;
 	}
 
-	// create field
-	Field nextField;
-	nextField.key = key;
-	nextField.value = val;
+	return !hasComment || m_handler.onComment(comment, m_line_num);
+}
 
-	// look for existing section
-	std::map<std::string, std::set<Field>>::iterator found = m_lookup.find(m_curr_section);
 
-	// section does not exist
-	if (found == m_lookup.end()) {
-		// create new set to hold all fields
-		std::set<Field> fields;
-		fields.insert(nextField);
+#if ALLOW_INCLUDES
+bool INIParser::parseInclude(std::string_view str, bool &handled) {
+	const std::string_view directive(INCLUDE_DIRECTIVE);
 
-		// add field to map
-		m_lookup.insert(std::map<std::string, std::set<Field>>::value_type(m_curr_section, fields));
+	// the directive must be followed by whitespace, so that keys starting
+	// with the same text are still keys
+	if (str.substr(0, directive.length()) != directive
+		|| (str.length() > directive.length() && str[directive.length()] != ' ' && str[directive.length()] != '\t')) {
 		return true;
 	}
 
-	// section already exists, insert new field
-	found->second.insert(nextField);
-	return true;
+	handled = true;
+	std::string_view path = INIReader::trim(str.substr(directive.length()));
+
+	// paths with surrounding whitespace can be quoted
+	if (path.length() >= 2 && path.front() == '"' && path.back() == '"') {
+		path = path.substr(1, path.length() - 2);
+	}
+
+	if (path.empty()) {
+		return fail(ErrorCode::NoPathForInclude);
+	}
+
+	TIME_PHASE(m_stats.handling);
+	return m_handler.onInclude(path, m_line_num);
+}
+#endif
+
+
+ErrorCode INIParser::finish() {
+	// the last section is not followed by another declaration that would
+	// check it
+	if (m_error == ErrorCode::None && m_in_section && m_section_empty) {
+		fail(ErrorCode::EmptySection);
+	}
+
+	return m_error;
+}
+
+
+bool INIParser::parseLine(std::string_view line) {
+	// ignore trailing whitespace
+	const std::string_view str = INIReader::rstrip(line);
+	return parseLine(str, markLine(str));
 }
 
 
-bool INIReader::parseLine(const std::string &str) {
+bool INIParser::parseLine(std::string_view str, const LineMarks &marks) {
+	++m_line_num;
+
 	// ignore newlines
 	if (str.length() < 1) {
 		return true;
 	}
 
-	const std::string s(START_COMMENT_PREFIXES);
+	const std::string_view s(START_COMMENT_PREFIXES);
 
-	// ignore start-of-line comments
-	if (s.find(str.at(0)) != std::string::npos) {
-		return true;
+	// start-of-line comments
+	if (s.find(str.at(0)) != std::string_view::npos) {
+		COUNT_STAT(m_stats.comments, 1);
+		TIME_PHASE(m_stats.handling);
+		return m_handler.onComment(str.substr(1), m_line_num);
 	}
 
 	// start of section
 	if (str.at(0) == '[') {
-		return parseSection(str);
+		return parseSection(str, marks.close);
 	}
 
-	const std::size_t assignIdx = str.find('=');
+#if ALLOW_INCLUDES
+	// include directive
+	if (str.at(0) == INCLUDE_DIRECTIVE[0]) {
+		bool handled = false;
+		const bool proceed = parseInclude(str, handled);
+
+		if (handled) {
+			return proceed;
+		}
+	}
+#endif
 
 	// check if assignment operator (=) exists
-	if (assignIdx == std::string::npos) {
-		m_error = ErrorCode::NoValueForKey;
-		return false;
+	if (marks.equals == LineMarks::npos) {
+		return fail(ErrorCode::NoValueForKey);
 	}
 
-	return parsePair(
-		str.substr(0, assignIdx),                            // key
-		str.substr(assignIdx + 1, str.length() - assignIdx)  // value
-	);
+	return parsePair(str, marks);
 }
 
 
-const std::string INIReader::get(
-	const std::string &section,
-	const std::string &key,
-	const std::string &defValue
-) const {
-	// no section exists
-	if (m_lookup.find(section) == m_lookup.end()) {
-		return defValue;
+bool INIParser::scanLines(std::string_view data, std::size_t &consumed) {
+	// classify a page at a time, so the kernels run over many blocks per call
+	constexpr std::size_t pageBlocks = 64;
+	std::uint64_t masks[pageBlocks];
+	char tail[64];
+
+	LineMarks marks;
+	std::size_t lineStart = 0;
+
+	for (std::size_t page = 0; page < data.length(); page += 64 * pageBlocks) {
+		const std::size_t length = std::min(data.length() - page, 64 * pageBlocks);
+		const std::size_t blocks = (length + 63) / 64;
+		classifyBlocks(data.data() + page, length / 64, masks);
+
+		// pad the last block so the kernels can always read 64 bytes
+		if (length % 64 != 0) {
+			std::memcpy(tail, data.data() + page + 64 * (blocks - 1), length % 64);
+			std::memset(tail + length % 64, ' ', 64 - length % 64);
+			classifyBlocks(tail, 1, &masks[blocks - 1]);
+			masks[blocks - 1] &= (std::uint64_t{ 1 } << (length % 64)) - 1;
+		}
+
+		for (std::size_t b = 0; b < blocks; ++b) {
+			const std::size_t block = page + 64 * b;
+
+			// visit the marked characters in order
+			for (std::uint64_t marked = masks[b]; marked; marked &= marked - 1) {
+				const std::size_t pos = block + lowestBit(marked);
+				const char c = data[pos];
+
+				if (c != '\n') {
+					mark(marks, c, pos - lineStart);
+					continue;
+				}
+
+				// ignore trailing whitespace
+				std::string_view str;
+				{
+					TIME_PHASE(m_stats.trimming);
+					str = INIReader::rstrip(data.substr(lineStart, pos - lineStart));
+				}
+
+				if (!parseLine(str, marks)) {
+					consumed = lineStart;
+					return false;
+				}
+
+				lineStart = pos + 1;
+				marks = LineMarks();
+			}
+		}
 	}
 
-	// find value associated with key
-	for (const auto &field : m_lookup.at(section)) {
-		if (field.key == key) {
-			return field.value;
+	consumed = lineStart;
+	return true;
+}
+
+
+ErrorCode INIParser::parse(std::string_view data) {
+	COUNT_STAT(m_stats.bytes, data.length());
+	TIME_PHASE(m_stats.total);
+	std::size_t consumed = 0;
+
+	if (!scanLines(data, consumed)) {
+		return m_error;
+	}
+
+	// last line has no line terminator
+	if (consumed < data.length() && !parseLine(data.substr(consumed))) {
+		return m_error;
+	}
+
+	return finish();
+}
+
+
+ErrorCode INIParser::parseStream(std::istream &in) {
+	TIME_PHASE(m_stats.total);
+	std::vector<char> block(64 * 1024);
+
+	// holds a line that is split across blocks
+	std::string carry;
+
+	while (in) {
+		{
+			TIME_PHASE(m_stats.reading);
+			in.read(block.data(), block.size());
+		}
+
+		std::string_view data(block.data(), static_cast<std::size_t>(in.gcount()));
+		COUNT_STAT(m_stats.bytes, data.length());
+
+		// finish the line carried over from the previous block
+		if (!carry.empty()) {
+			const char *newline = static_cast<const char *>(std::memchr(data.data(), '\n', data.length()));
+
+			if (!newline) {
+				carry.append(data);
+				continue;
+			}
+
+			const std::size_t end = newline - data.data();
+			carry.append(data.substr(0, end));
+
+			if (!parseLine(carry)) {
+				return m_error;
+			}
+
+			carry.clear();
+			data.remove_prefix(end + 1);
+		}
+
+		std::size_t consumed = 0;
+		if (!scanLines(data, consumed)) {
+			return m_error;
 		}
+
+		// rest of the block is the start of a line
+		carry.assign(data.substr(consumed));
 	}
 
-	return defValue;
+	// last line has no line terminator
+	if (!carry.empty() && !parseLine(carry)) {
+		return m_error;
+	}
+
+	return finish();
 }
 
 
-INIReader::INIReader(const char *fileName) {
-	// read file
-	std::ifstream file(fileName);
+LoadStats INIParser::getStats() const {
+#if COLLECT_LOAD_STATS
+	LoadStats stats = m_stats;
+	stats.lines = static_cast<std::size_t>(m_line_num);
+
+	// whatever time was not spent elsewhere was spent finding lines and their parts
+	stats.lexing = std::max(std::chrono::nanoseconds(0), stats.total - stats.reading - stats.trimming - stats.handling);
+	return stats;
+#else
+	return LoadStats();
+#endif
+}
+
+
+ErrorCode INIParser::parseFile(const char *fileName) {
+	std::ifstream file(fileName, std::ios::binary);
 
 	// check if file could be opened
 	if (file.fail()) {
-		m_error = ErrorCode::NoSuchFile;
-		return;
+		fail(ErrorCode::NoSuchFile);
+		return m_error;
 	}
 
-	std::string currLine;
-	m_line_num = 1;
+	return parseStream(file);
+}
+
 
-	// go through each line in file
-	while (std::getline(file, currLine)) {
-		// strip trailing whitespace
-		rstrip(currLine);
+/**
+ * @brief Stores every section and field found by the parser in the contents
+ * of a reader.
+ */
+class INIReader::Builder : public INIHandler {
 
-		// parse current line
-		if (!parseLine(currLine)) {
-			break;
+private:
+
+	/**
+	 * @brief The contents being built.
+	 */
+	Contents &m_contents;
+
+	/**
+	 * @brief The current section, stored in `m_contents`.
+	 */
+	std::string_view m_curr_section;
+
+	/**
+	 * @brief Makes sure that `str` outlives the current line.
+	 * @param str Part of the line that is currently being parsed.
+	 * @returns A view of the same text that stays valid for the lifetime of
+	 * the contents.
+	 */
+	std::string_view store(std::string_view str);
+
+public:
+
+	explicit Builder(Contents &contents) : m_contents(contents) {}
+
+	bool onSection(std::string_view name, int) override {
+		m_curr_section = store(name);
+		m_contents.addSection(m_curr_section);
+		return true;
+	}
+
+	bool onKeyValue(std::string_view, std::string_view key, std::string_view value, int) override {
+		Field field;
+		field.key = store(key);
+		field.value = store(value);
+
+		{
+			TIME_PHASE(m_contents.stats.converting);
+			field.typed = convertAll(value);
 		}
 
-		++m_line_num;
+		// add field to its section, creating the section if it does not exist
+		m_contents.addField(m_curr_section, field);
+		return true;
+	}
+
+	bool onInclude(std::string_view path, int) override {
+		m_contents.includes.emplace_back(path);
+		return true;
 	}
 
-	// close file reader
-	file.close();
+};
+
+
+#if USE_PMR_STORAGE
+INIReader::Contents::Contents(const std::size_t sizeHint) :
+#	if USE_ARENA_STORAGE && COLLECT_LOAD_STATS
+	// only the blocks of the arena come from the heap
+	arena(std::max<std::size_t>(sizeHint, 4096), &counter),
+#	elif USE_ARENA_STORAGE
+	arena(std::max<std::size_t>(sizeHint, 4096)),
+#	endif
+#	if COLLECT_LOAD_STATS
+	strings(storage()),
+#	endif
+#	if USE_FLAT_STORAGE
+	fields(storage()),
+	sections(storage()),
+	sectionNames(storage())
+#	else
+	lookup(storage()),
+	sectionNames(storage())
+#	endif
+{
+	static_cast<void>(sizeHint);
 }
+#else
+INIReader::Contents::Contents(std::size_t) {}
+#endif
 
 
-const bool INIReader::success() const {
-	return m_error == ErrorCode::None;
+#if COLLECT_LOAD_STATS
+void INIReader::Contents::addParseStats(const LoadStats &parsed) {
+	stats += parsed;
+
+	// everything the handler did besides converting values was storing them
+	stats.inserting = stats.handling - stats.converting;
 }
 
 
-const std::string INIReader::getString(
-	const std::string &section,
-	const std::string &key,
-	const std::string &defValue
-) const {
-	const std::string str = get(section, key, "");
-	return str.empty() ? defValue : str;
+void INIReader::Contents::finishStats(const std::chrono::steady_clock::time_point start) {
+	stats.total = std::chrono::steady_clock::now() - start;
+	stats.allocations = counter.allocations();
+	stats.peakBytes = counter.peakBytes();
 }
+#endif
 
 
-const int INIReader::getInt(
-	const std::string &section,
-	const std::string &key,
-	const int defValue
-) const {
-	const std::string str = get(section, key, "");
-	return str.empty() ? defValue : std::stoi(str);
+#if USE_FLAT_STORAGE
+void INIReader::Contents::addSection(std::string_view name) {
+	// sorted and made unique in `finish`
+	sectionNames.push_back(name);
 }
 
 
-const long INIReader::getLong(
-	const std::string &section,
-	const std::string &key,
-	const long defValue
-) const {
-	const std::string str = get(section, key, "");
-	return str.empty() ? defValue : std::stol(str);
+void INIReader::Contents::addField(std::string_view section, const Field &field) {
+	// duplicates are removed in `finish`
+	pending.emplace_back(section, field);
 }
 
 
-const double INIReader::getDouble(
-	const std::string &section,
-	const std::string &key,
-	const double defValue
-) const {
-	const std::string str = get(section, key, "");
-	return str.empty() ? defValue : std::stod(str);
-}
+void INIReader::Contents::finish() {
+	TIME_PHASE(stats.indexing);
+	std::sort(sectionNames.begin(), sectionNames.end());
+	sectionNames.erase(std::unique(sectionNames.begin(), sectionNames.end()), sectionNames.end());
 
+	// a stable sort keeps the first of several fields with the same key first
+	std::stable_sort(pending.begin(), pending.end(), [](const auto &a, const auto &b) {
+		return a.first < b.first || (a.first == b.first && a.second.key < b.second.key);
+	});
 
-const bool INIReader::getBool(
-	const std::string &section,
-	const std::string &key,
-	const bool defValue
-) const {
-	std::string str = get(section, key, "");
-	if (str.empty()) {
-		return defValue;
+	fields.reserve(pending.size());
+
+	for (const auto &entry : pending) {
+		const bool newSection = sections.empty() || sections.back().name != entry.first;
+
+		// only keep the first field with each key in a section
+		if (!newSection && fields.back().key == entry.second.key) {
+			continue;
+		}
+
+		if (newSection) {
+			sections.push_back(Section{ entry.first, fields.size(), fields.size() });
+		}
+
+		fields.push_back(entry.second);
+		++sections.back().last;
 	}
 
-	// convert to lowercase for case-insensitive checking
-	std::transform(
-		str.begin(),
-		str.end(),
-		str.begin(),
-		[](unsigned char c){ return std::tolower(c); }
-	);
+	pending.clear();
+	pending.shrink_to_fit();
 
-	if (str == "true" || str == "yes" || str == "on" || str == "1") {
-		return true;
-	} else if (str == "false" || str == "no" || str == "off" || str == "0") {
-		return false;
-	} else {
-		return defValue;
+	// fields no longer move, so they can be indexed
+	index.clear();
+	for (const auto &section : sections) {
+		for (std::size_t i = section.first; i < section.last; ++i) {
+			index.insert(section.name, &fields[i]);
+		}
 	}
 }
+
+
+void INIReader::Contents::reserve(const std::size_t sectionCount, const std::size_t fieldCount) {
+	sectionNames.reserve(sectionCount);
+	sections.reserve(sectionCount);
+	fields.reserve(fieldCount);
+	index.reserve(fieldCount);
+}
+
+
+void INIReader::Contents::appendSection(std::string_view name) {
+	sectionNames.push_back(name);
+}
+
+
+const Field *INIReader::Contents::appendField(std::string_view section, const Field &field) {
+	if (sections.empty() || sections.back().name != section) {
+		sections.push_back(Section{ section, fields.size(), fields.size() });
+	}
+
+	// room was reserved for every field, so none of them move
+	fields.push_back(field);
+	++sections.back().last;
+	return &fields.back();
+}
+#else
+void INIReader::Contents::addSection(std::string_view name) {
+	sectionNames.insert(name);
+}
+
+
+void INIReader::Contents::addField(std::string_view section, const Field &field) {
+	lookup.try_emplace(section).first->second.insert(field);
+}
+
+
+void INIReader::Contents::finish() {
+	TIME_PHASE(stats.indexing);
+	index.clear();
+
+	for (const auto &entry : lookup) {
+		for (const auto &field : entry.second) {
+			index.insert(entry.first, &field);
+		}
+	}
+}
+
+
+void INIReader::Contents::reserve(std::size_t, const std::size_t fieldCount) {
+	index.reserve(fieldCount);
+}
+
+
+void INIReader::Contents::appendSection(std::string_view name) {
+	sectionNames.emplace_hint(sectionNames.end(), name);
+}
+
+
+const Field *INIReader::Contents::appendField(std::string_view section, const Field &field) {
+	if (lookup.empty() || lookup.rbegin()->first != section) {
+		lookup.try_emplace(lookup.end(), section);
+	}
+
+	FieldSet &set = lookup.rbegin()->second;
+	return &*set.emplace_hint(set.end(), field);
+}
+#endif
+
+
+std::string_view INIReader::Contents::store(std::string_view str) {
+#if USE_ARENA_STORAGE
+	char *text = static_cast<char *>(arena.allocate(str.length(), 1));
+	std::memcpy(text, str.data(), str.length());
+	return std::string_view(text, str.length());
+#else
+	return strings.emplace_back(str);
+#endif
+}
+
+
+std::string_view INIReader::Builder::store(std::string_view str) {
+	// text parsed in place already lives as long as the reader
+	if (m_contents.inPlace) {
+		return str;
+	}
+
+	return m_contents.store(str);
+}
+
+
+void INIReader::readStream(const char *fileName) {
+	// read file
+	std::ifstream file(fileName, std::ios::binary);
+
+	// check if file could be opened
+	if (file.fail()) {
+		m_contents = std::make_shared<Contents>(0);
+		m_error = ErrorCode::NoSuchFile;
+		return;
+	}
+
+	// size the arena for the whole file
+	file.seekg(0, std::ios::end);
+	m_contents = std::make_shared<Contents>(static_cast<std::size_t>(file.tellg()));
+	file.seekg(0, std::ios::beg);
+
+	Builder builder(*m_contents);
+	INIParser parser(builder);
+	m_error = parser.parseStream(file);
+
+#if COLLECT_LOAD_STATS
+	m_contents->addParseStats(parser.getStats());
+#endif
+}
+
+
+void INIReader::readMapped(const char *fileName) {
+#if COLLECT_LOAD_STATS
+	const auto mapStart = std::chrono::steady_clock::now();
+#endif
+	std::shared_ptr<const MappedFile> mapping = std::make_shared<const MappedFile>(fileName);
+
+	// check if file could be opened
+	if (!mapping->isOpen()) {
+		m_contents = std::make_shared<Contents>(0);
+		m_error = ErrorCode::NoSuchFile;
+		return;
+	}
+
+	// only container nodes go in the arena, the text stays in the mapping
+	m_contents = std::make_shared<Contents>(mapping->data().length());
+	m_contents->mapping = mapping;
+
+#if COLLECT_LOAD_STATS
+	m_contents->stats.reading = std::chrono::steady_clock::now() - mapStart;
+#endif
+
+	readInPlace(mapping->data());
+}
+
+
+struct INIReader::Chunk {
+	// Text of this part of the file, which starts at a section declaration
+	// (except for the first part).
+	std::string_view data;
+
+	// Names of the sections declared in this part, in order.
+	std::vector<std::string_view> sections;
+
+	// Fields in this part along with their section, in order.
+	std::vector<std::pair<std::string_view, Field>> fields;
+
+	// Paths given to the include directives in this part, in order.
+	std::vector<std::string> includes;
+
+	// Error that occurred while parsing this part, if any.
+	ErrorCode error{ ErrorCode::None };
+
+#if COLLECT_LOAD_STATS
+	// What the parser found in this part and where its time went.
+	LoadStats stats;
+#endif
+};
+
+
+class INIReader::ChunkBuilder : public INIHandler {
+
+private:
+
+	/**
+	 * @brief The chunk being built.
+	 */
+	Chunk &m_chunk;
+
+	/**
+	 * @brief The current section, which points into the mapped file.
+	 */
+	std::string_view m_curr_section;
+
+public:
+
+	explicit ChunkBuilder(Chunk &chunk) : m_chunk(chunk) {}
+
+	bool onSection(std::string_view name, int) override {
+		m_curr_section = name;
+		m_chunk.sections.push_back(name);
+		return true;
+	}
+
+	bool onKeyValue(std::string_view, std::string_view key, std::string_view value, int) override {
+		Field field;
+		field.key = key;
+		field.value = value;
+
+		{
+			TIME_PHASE(m_chunk.stats.converting);
+			field.typed = convertAll(value);
+		}
+
+		m_chunk.fields.emplace_back(m_curr_section, field);
+		return true;
+	}
+
+	bool onInclude(std::string_view path, int) override {
+		m_chunk.includes.emplace_back(path);
+		return true;
+	}
+
+};
+
+
+void INIReader::mergeChunk(const Chunk &chunk, const bool copy) {
+	std::size_t nextField = 0;
+
+	for (const std::string_view &section : chunk.sections) {
+		const std::string_view name = copy ? m_contents->store(section) : section;
+		m_contents->addSection(name);
+
+		// add the fields up to the next section, keeping the order of the file
+		while (nextField < chunk.fields.size() && chunk.fields[nextField].first.data() == section.data()) {
+			Field field = chunk.fields[nextField].second;
+
+			if (copy) {
+				field.key = m_contents->store(field.key);
+				field.value = m_contents->store(field.value);
+			}
+
+			m_contents->addField(name, field);
+			++nextField;
+		}
+	}
+}
+
+
+void INIReader::readParallel(const char *fileName, unsigned threads) {
+#if COLLECT_LOAD_STATS
+	const auto mapStart = std::chrono::steady_clock::now();
+#endif
+	std::shared_ptr<const MappedFile> mapping = std::make_shared<const MappedFile>(fileName);
+
+	// check if file could be opened
+	if (!mapping->isOpen()) {
+		m_contents = std::make_shared<Contents>(0);
+		m_error = ErrorCode::NoSuchFile;
+		return;
+	}
+
+	m_contents = std::make_shared<Contents>(mapping->data().length());
+	m_contents->mapping = mapping;
+	m_contents->inPlace = true;
+
+#if COLLECT_LOAD_STATS
+	m_contents->stats.reading = std::chrono::steady_clock::now() - mapStart;
+#endif
+
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// split the file into a few chunks per thread, each starting at a line
+	// that declares a section, so every chunk can be parsed on its own
+	const std::string_view data = mapping->data();
+	const std::size_t target = static_cast<std::size_t>(threads) * 4;
+	std::vector<Chunk> chunks;
+	std::size_t start = 0;
+
+	for (std::size_t i = 1; i <= target && start < data.length(); ++i) {
+		std::size_t end = data.length();
+
+		if (i < target) {
+			const std::size_t from = std::max(start, data.length() * i / target);
+			const std::size_t found = data.find("\n[", from);
+			end = (found == std::string_view::npos) ? data.length() : found + 1;
+		}
+
+		chunks.emplace_back();
+		chunks.back().data = data.substr(start, end - start);
+		start = end;
+	}
+
+	// parse the chunks on a pool of threads
+	std::atomic<std::size_t> next{ 0 };
+	const auto work = [&chunks, &next]() {
+		for (std::size_t i = next++; i < chunks.size(); i = next++) {
+			ChunkBuilder builder(chunks[i]);
+			INIParser parser(builder);
+			chunks[i].error = parser.parse(chunks[i].data);
+
+#if COLLECT_LOAD_STATS
+			chunks[i].stats += parser.getStats();
+#endif
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned t = 1; t < threads && t < chunks.size(); ++t) {
+		pool.emplace_back(work);
+	}
+	work();
+
+	for (auto &thread : pool) {
+		thread.join();
+	}
+
+#if COLLECT_LOAD_STATS
+	// times are added up over every thread
+	for (const Chunk &chunk : chunks) {
+		m_contents->addParseStats(chunk.stats);
+	}
+#endif
+
+	// merge the chunks in file order, stopping where the serial parser would;
+	// a chunk that ends with an empty section fails at its end, which is where
+	// the serial parser reaches the next declaration (or the end of the file)
+	TIME_PHASE(m_contents->stats.inserting);
+	for (const Chunk &chunk : chunks) {
+		mergeChunk(chunk, false);
+		m_contents->includes.insert(m_contents->includes.end(), chunk.includes.begin(), chunk.includes.end());
+
+		if (chunk.error != ErrorCode::None) {
+			m_error = chunk.error;
+			break;
+		}
+	}
+}
+
+
+void INIReader::readInPlace(std::string_view data) {
+	m_contents->inPlace = true;
+
+	Builder builder(*m_contents);
+	INIParser parser(builder);
+	m_error = parser.parse(data);
+
+#if COLLECT_LOAD_STATS
+	m_contents->addParseStats(parser.getStats());
+#endif
+}
+
+
+struct INIReader::IncludedFile {
+	// Path of the file, as it was found.
+	std::filesystem::path path;
+
+	// Contents of the file, which the chunk points into.
+	std::shared_ptr<const MappedFile> mapping;
+
+	// Sections and fields parsed from the file.
+	Chunk chunk;
+
+	// Positions of the files named by the include directives of this file,
+	// in the order they are added.
+	std::vector<std::size_t> files;
+};
+
+
+/**
+ * @brief Checks if a file name matches a pattern, where `*` matches any
+ * number of characters and `?` matches any single character.
+ */
+static bool matchesGlob(std::string_view pattern, std::string_view name) {
+	std::size_t p = 0;
+	std::size_t n = 0;
+
+	// where to resume after the last `*` when the rest of the pattern fails
+	std::size_t star = std::string_view::npos;
+	std::size_t resume = 0;
+
+	while (n < name.length()) {
+		if (p < pattern.length() && (pattern[p] == '?' || pattern[p] == name[n])) {
+			++p;
+			++n;
+		} else if (p < pattern.length() && pattern[p] == '*') {
+			star = p++;
+			resume = n;
+		} else if (star != std::string_view::npos) {
+			// let the `*` match one more character
+			p = star + 1;
+			n = ++resume;
+		} else {
+			return false;
+		}
+	}
+
+	while (p < pattern.length() && pattern[p] == '*') {
+		++p;
+	}
+
+	return p == pattern.length();
+}
+
+
+/**
+ * @brief Finds the files named by an include directive.
+ * @param pattern The path given to the directive, whose last part may
+ * contain wildcards.
+ * @param directory The directory of the including file.
+ * @param files Set to the files found, ordered by path.
+ * @returns `false` if a path without wildcards does not name a file.
+ */
+static bool resolveInclude(std::string_view pattern, const std::filesystem::path &directory, std::vector<std::filesystem::path> &files) {
+	namespace fs = std::filesystem;
+
+	// an absolute path replaces the directory
+	const fs::path path = directory / fs::path(pattern);
+	const std::string name = path.filename().string();
+	std::error_code error;
+
+	if (name.find_first_of("*?") == std::string::npos) {
+		if (!fs::is_regular_file(path, error)) {
+			return false;
+		}
+
+		files.push_back(path);
+		return true;
+	}
+
+	// a pattern that matches nothing includes nothing, and like a shell it
+	// only matches hidden files when it asks for them
+	for (fs::directory_iterator it(path.parent_path(), error), end; !error && it != end; it.increment(error)) {
+		const std::string found = it->path().filename().string();
+		std::error_code typeError;
+
+		if ((found[0] != '.' || name[0] == '.') && matchesGlob(name, found) && it->is_regular_file(typeError)) {
+			files.push_back(it->path());
+		}
+	}
+
+	std::sort(files.begin(), files.end());
+	return true;
+}
+
+
+/**
+ * @returns A path that is the same for every way of naming the same file.
+ */
+static std::filesystem::path canonicalPath(const std::filesystem::path &path) {
+	std::error_code error;
+	const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+	return error ? path.lexically_normal() : canonical;
+}
+
+
+ErrorCode INIReader::mergeIncluded(const std::deque<IncludedFile> &files, const std::size_t idx, std::vector<std::uint8_t> &state, const bool copy) {
+	enum : std::uint8_t { Unvisited, Visiting, Visited };
+
+	// reaching a file that is still being added means it includes itself
+	if (state[idx] == Visiting) {
+		return ErrorCode::IncludeCycle;
+	}
+
+	// a file included more than once has nothing new to add
+	if (state[idx] == Visited) {
+		return ErrorCode::None;
+	}
+
+	const IncludedFile &file = files[idx];
+
+	if (idx > 0) {
+		mergeChunk(file.chunk, copy);
+	}
+
+	if (file.chunk.error != ErrorCode::None) {
+		return file.chunk.error;
+	}
+
+	state[idx] = Visiting;
+
+	for (const std::size_t included : file.files) {
+		const ErrorCode error = mergeIncluded(files, included, state, copy);
+
+		if (error != ErrorCode::None) {
+			return error;
+		}
+	}
+
+	state[idx] = Visited;
+	return ErrorCode::None;
+}
+
+
+void INIReader::readIncludes(const char *fileName, const char *directory, unsigned threads) {
+	namespace fs = std::filesystem;
+
+	if (m_contents->includes.empty() || m_error != ErrorCode::None) {
+		return;
+	}
+
+	m_contents->hasIncludes = true;
+
+	// text that is not in a file may only include files when asked to
+	if (!fileName && !directory) {
+		m_contents->includes.clear();
+		m_error = ErrorCode::IncludeNotAllowed;
+		return;
+	}
+
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// every file is loaded once, however many times and however it is
+	// named, starting with the file that was parsed
+	std::deque<IncludedFile> files(1);
+	std::map<fs::path, std::size_t> known;
+
+	if (fileName) {
+		files[0].path = fileName;
+		known.emplace(canonicalPath(files[0].path), 0);
+	}
+
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::vector<std::size_t> queue;
+	std::size_t busy = 0;
+
+	// relative paths in a file are resolved against its directory
+	const auto directoryOf = [](const fs::path &path) {
+		return path.has_parent_path() ? path.parent_path() : fs::path(".");
+	};
+
+	// finds the files named by the directives of a file, queueing the ones
+	// that have not been seen yet
+	const auto resolve = [&](IncludedFile &file, const fs::path &directory, const std::vector<std::string> &directives) {
+		for (const std::string &directive : directives) {
+			std::vector<fs::path> found;
+
+			// remembered even if nothing is found, so a watcher notices files
+			// added there later
+			{
+				const std::string where = (directory / fs::path(directive)).parent_path().lexically_normal().string();
+				std::lock_guard<std::mutex> lock(mutex);
+				std::vector<std::string> &watched = m_contents->includeDirectories;
+
+				if (std::find(watched.begin(), watched.end(), where) == watched.end()) {
+					watched.push_back(where);
+				}
+			}
+
+			if (!resolveInclude(directive, directory, found)) {
+				file.chunk.error = ErrorCode::NoSuchInclude;
+				return;
+			}
+
+			for (const fs::path &path : found) {
+				const fs::path canonical = canonicalPath(path);
+				std::lock_guard<std::mutex> lock(mutex);
+				const auto entry = known.try_emplace(canonical, files.size());
+
+				if (entry.second) {
+					files.emplace_back();
+					files.back().path = path;
+					queue.push_back(entry.first->second);
+					ready.notify_one();
+				}
+
+				file.files.push_back(entry.first->second);
+			}
+		}
+	};
+
+	// parses a file in place, then looks for the files it includes
+	const auto load = [&](IncludedFile &file) {
+		file.mapping = std::make_shared<const MappedFile>(file.path.string().c_str());
+
+		if (!file.mapping->isOpen()) {
+			file.chunk.error = ErrorCode::NoSuchInclude;
+			return;
+		}
+
+		file.chunk.data = file.mapping->data();
+		ChunkBuilder builder(file.chunk);
+		INIParser parser(builder);
+		file.chunk.error = parser.parse(file.chunk.data);
+
+#if COLLECT_LOAD_STATS
+		file.chunk.stats += parser.getStats();
+#endif
+
+		if (file.chunk.error == ErrorCode::None) {
+			resolve(file, directoryOf(file.path), file.chunk.includes);
+		}
+	};
+
+	// workers are started only while there are more files queued than idle
+	// workers, so a single include is loaded without starting any threads
+	std::vector<std::thread> pool;
+	std::function<void()> work = [&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		for (;;) {
+			while (queue.size() > pool.size() + 1 - busy && pool.size() + 1 < threads) {
+				pool.emplace_back(work);
+			}
+
+			// wait for a file, or for every file to have been loaded
+			ready.wait(lock, [&]() { return !queue.empty() || busy == 0; });
+
+			if (queue.empty()) {
+				return;
+			}
+
+			// files never move once added, so the file can be used unlocked
+			IncludedFile &file = files[queue.back()];
+			queue.pop_back();
+			++busy;
+
+			lock.unlock();
+			load(file);
+			lock.lock();
+
+			if (--busy == 0 && queue.empty()) {
+				ready.notify_all();
+			}
+		}
+	};
+
+	resolve(files[0], fileName ? directoryOf(files[0].path) : fs::path(directory), m_contents->includes);
+	work();
+
+	// no worker is started once the queue has drained
+	for (auto &thread : pool) {
+		thread.join();
+	}
+
+	// add the files in the order of their directives, whichever thread
+	// finished first. Included files are only kept mapped if the reader
+	// already depends on a mapped file; otherwise their text is copied, so
+	// that editing them in place cannot change or break the reader
+	const bool copy = !m_contents->mapping;
+	std::vector<std::uint8_t> state(files.size(), 0);
+	{
+		TIME_PHASE(m_contents->stats.inserting);
+		m_error = mergeIncluded(files, 0, state, copy);
+	}
+
+	for (std::size_t i = 1; i < files.size(); ++i) {
+#if COLLECT_LOAD_STATS
+		m_contents->addParseStats(files[i].chunk.stats);
+#endif
+
+		if (files[i].mapping && !copy) {
+			m_contents->included.push_back(std::move(files[i].mapping));
+		}
+	}
+
+	m_contents->includes.clear();
+}
+
+
+INIReader::INIReader(const char *fileName, const LoadMode mode, const unsigned threads) {
+	START_LOAD();
+
+	if (mode == LoadMode::Parallel) {
+		readParallel(fileName, threads);
+	} else if (mode == LoadMode::Mapped) {
+		readMapped(fileName);
+	} else {
+		readStream(fileName);
+	}
+
+	readIncludes(fileName, nullptr, threads);
+	m_contents->finish();
+	FINISH_LOAD(*m_contents);
+}
+
+
+INIReader INIReader::fromString(std::string contents, const char *includeDirectory) {
+	START_LOAD();
+	INIReader reader;
+	reader.m_contents = std::make_shared<Contents>(contents.length());
+
+	// parse the copy owned by the contents, which will not move again
+	reader.m_contents->buffer = std::move(contents);
+	reader.readInPlace(reader.m_contents->buffer);
+	reader.readIncludes(nullptr, includeDirectory, 0);
+	reader.m_contents->finish();
+	FINISH_LOAD(*reader.m_contents);
+
+	return reader;
+}
+
+
+INIReader INIReader::fromView(std::string_view contents, const char *includeDirectory) {
+	START_LOAD();
+	INIReader reader;
+	reader.m_contents = std::make_shared<Contents>(contents.length());
+
+	reader.readInPlace(contents);
+	reader.readIncludes(nullptr, includeDirectory, 0);
+	reader.m_contents->finish();
+	FINISH_LOAD(*reader.m_contents);
+
+	return reader;
+}
+
+
+INIReader INIReader::fromLayers(const std::vector<INIReader> &layers) {
+	START_LOAD();
+	INIReader reader;
+	reader.m_contents = std::make_shared<Contents>(0);
+
+	// sections and fields point into the layers, which are kept alive here
+	Contents &contents = *reader.m_contents;
+	contents.inPlace = true;
+
+	for (const INIReader &layer : layers) {
+		contents.layers.push_back(layer.m_contents);
+
+		if (reader.m_error == ErrorCode::None) {
+			reader.m_error = layer.m_error;
+		}
+	}
+
+	{
+		TIME_PHASE(contents.stats.inserting);
+
+		// the first field added with each key is kept, so the layers are added
+		// from the top down, and empty values only once every other value is in
+		for (const bool empty : { false, true }) {
+			for (auto layer = layers.rbegin(); layer != layers.rend(); ++layer) {
+				for (const std::string_view section : layer->getSectionNames()) {
+					if (!empty) {
+						contents.addSection(section);
+					}
+
+					for (const Field &field : layer->tryGetSectionFields(section)) {
+						if (field.value.empty() == empty) {
+							contents.addField(section, field);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	contents.finish();
+	FINISH_LOAD(contents);
+
+	return reader;
+}
+
+
+int INIReader::getLayer(std::string_view section, std::string_view key) const {
+	const std::uint64_t hash = FieldIndex::hash(section, key);
+	const Field *field = m_contents->index.find(section, key, hash);
+
+	if (!field || field->value.empty()) {
+		return -1;
+	}
+
+	const auto &layers = m_contents->layers;
+
+	// the value points into the text of the layer it was taken from
+	for (std::size_t i = layers.size(); i-- > 0;) {
+		const Field *found = layers[i]->index.find(section, key, hash);
+
+		if (found && found->value.data() == field->value.data()) {
+			return static_cast<int>(i);
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * @brief Version of the cache format, which is increased whenever the layout
+ * of the cache changes.
+ */
+static constexpr std::uint32_t CACHE_VERSION = 1;
+
+/**
+ * @brief Identifies cache files.
+ */
+static constexpr char CACHE_MAGIC[8]{ 'D', 'O', 'T', 'I', 'N', 'I', 'C', '\0' };
+
+/**
+ * @brief The start of a cache file, followed by the sections, the fields and
+ * then all of their text. Every position in the file is an offset, so the
+ * file can be mapped at any address.
+ */
+struct CacheHeader {
+	char magic[8];
+	std::uint32_t version;
+
+	// Size of `CacheField`, which changes with the layout of `TypedValue`.
+	std::uint32_t fieldSize;
+
+	// Hash of the options that change how text is parsed.
+	std::uint64_t options;
+
+	// The source file the cache was built from.
+	std::uint64_t sourceSize;
+	std::int64_t sourceTime;
+	std::uint64_t sourceHash;
+
+	std::uint64_t sectionCount;
+	std::uint64_t fieldCount;
+	std::uint64_t textSize;
+};
+
+/**
+ * @brief The name of a section in a cache file.
+ */
+struct CacheSection {
+	std::uint64_t offset;
+	std::uint64_t length;
+};
+
+/**
+ * @brief A field in a cache file, along with its index hash and its value
+ * already converted to every type.
+ */
+struct CacheField {
+	std::uint64_t hash;
+	std::uint64_t keyOffset;
+	std::uint64_t valueOffset;
+	std::uint32_t section;
+	std::uint32_t keyLength;
+	std::uint32_t valueLength;
+	TypedValue typed;
+};
+
+static_assert(std::is_trivially_copyable_v<CacheField>, "cache records are copied as raw bytes");
+
+/**
+ * @brief Hash of the options that change how text is parsed, so that a cache
+ * is not used by a build that would parse the source differently.
+ */
+static constexpr std::uint64_t CACHE_OPTIONS = FieldIndex::hash(START_COMMENT_PREFIXES, "");
+
+struct INIReader::CacheStamp {
+	std::uint64_t size{ 0 };
+	std::int64_t time{ 0 };
+	std::uint64_t hash{ 0 };
+};
+
+
+/**
+ * @brief Hashes the contents of a file 8 bytes at a time, which is much
+ * faster than parsing them.
+ */
+static std::uint64_t hashBytes(std::string_view data) {
+	std::uint64_t h = 14695981039346656037ull ^ data.length();
+	std::size_t i = 0;
+
+	for (; i + 8 <= data.length(); i += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, data.data() + i, 8);
+		h = (h ^ word) * 0x9e3779b97f4a7c15ull;
+		h ^= h >> 32;
+	}
+
+	for (; i < data.length(); ++i) {
+		h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+	}
+
+	return h;
+}
+
+
+/**
+ * @brief Gets the modification time of a file in nanoseconds.
+ * @returns `true` if the time could be read, `false` otherwise.
+ */
+static bool modificationTime(const char *fileName, std::int64_t &time) {
+	std::error_code error;
+	const auto modified = std::filesystem::last_write_time(fileName, error);
+
+	if (error) {
+		return false;
+	}
+
+	time = std::chrono::duration_cast<std::chrono::nanoseconds>(modified.time_since_epoch()).count();
+	return true;
+}
+
+
+/**
+ * @returns The name of a temporary file next to `fileName`. Several
+ * processes and threads may replace the same file at once, so each one gets
+ * its own name.
+ */
+static std::string tempFileName(const char *fileName) {
+#if HAS_MMAP
+	const std::size_t writer = static_cast<std::size_t>(::getpid());
+#else
+	const std::size_t writer = 0;
+#endif
+	return std::string(fileName) + ".tmp" + std::to_string(writer)
+		+ "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+
+/**
+ * @brief Replaces a file with `data` by writing it to a temporary file next
+ * to it and renaming that over the original, so that nobody ever reads a
+ * partly written file.
+ * @returns `true` if the file was replaced, `false` otherwise.
+ */
+static bool replaceFile(const char *fileName, std::string_view data) {
+	const std::string temp = tempFileName(fileName);
+
+	{
+		std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+		out.write(data.data(), static_cast<std::streamsize>(data.length()));
+		out.close();
+
+		if (out.fail()) {
+			std::remove(temp.c_str());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temp, fileName, error);
+
+	if (error) {
+		std::remove(temp.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+bool INIReader::readCache(const char *cacheName, const CacheStamp &stamp) {
+	std::shared_ptr<const MappedFile> cache = std::make_shared<const MappedFile>(cacheName);
+	const std::string_view data = cache->data();
+	CacheHeader header;
+
+	if (!cache->isOpen() || data.length() < sizeof(header)) {
+		return false;
+	}
+
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION
+		|| header.fieldSize != sizeof(CacheField) || header.options != CACHE_OPTIONS) {
+		return false;
+	}
+
+	if (header.sourceSize != stamp.size || header.sourceTime != stamp.time || header.sourceHash != stamp.hash) {
+		return false;
+	}
+
+	// make sure the tables fit in the file before touching them
+	if (header.sectionCount > data.length() || header.fieldCount > data.length()) {
+		return false;
+	}
+
+	const std::size_t sectionsAt = sizeof(CacheHeader);
+	const std::size_t fieldsAt = sectionsAt + header.sectionCount * sizeof(CacheSection);
+	const std::size_t textAt = fieldsAt + header.fieldCount * sizeof(CacheField);
+
+	if (textAt > data.length() || data.length() - textAt != header.textSize) {
+		return false;
+	}
+
+	// everything points into the mapped cache, so no text is copied
+	const std::string_view text = data.substr(textAt);
+	std::shared_ptr<Contents> contents = std::make_shared<Contents>(static_cast<std::size_t>(textAt));
+	contents->mapping = cache;
+	contents->inPlace = true;
+	contents->cached = true;
+	contents->reserve(header.sectionCount, header.fieldCount);
+
+	for (std::size_t i = 0; i < header.sectionCount; ++i) {
+		CacheSection section;
+		std::memcpy(&section, data.data() + sectionsAt + i * sizeof(CacheSection), sizeof(section));
+
+		if (section.offset > text.length() || section.length > text.length() - section.offset) {
+			return false;
+		}
+
+		contents->appendSection(text.substr(section.offset, section.length));
+	}
+
+	std::string_view section;
+	std::uint32_t sectionIdx = 0;
+
+	for (std::size_t i = 0; i < header.fieldCount; ++i) {
+		CacheField record;
+		std::memcpy(&record, data.data() + fieldsAt + i * sizeof(CacheField), sizeof(record));
+
+		if (record.section >= header.sectionCount || record.keyOffset > text.length() || record.keyLength > text.length() - record.keyOffset
+			|| record.valueOffset > text.length() || record.valueLength > text.length() - record.valueOffset) {
+			return false;
+		}
+
+		if (i == 0 || record.section != sectionIdx) {
+			CacheSection name;
+			std::memcpy(&name, data.data() + sectionsAt + record.section * sizeof(CacheSection), sizeof(name));
+			section = text.substr(name.offset, name.length);
+			sectionIdx = record.section;
+		}
+
+		Field field;
+		field.key = text.substr(record.keyOffset, record.keyLength);
+		field.value = text.substr(record.valueOffset, record.valueLength);
+		field.typed = record.typed;
+
+		// the stored hash saves hashing every key again
+		contents->index.insert(section, contents->appendField(section, field), record.hash);
+	}
+
+#if COLLECT_LOAD_STATS
+	contents->stats.bytes = data.length();
+	contents->stats.sections = header.sectionCount;
+	contents->stats.fields = header.fieldCount;
+#endif
+
+	m_contents = std::move(contents);
+	m_error = ErrorCode::None;
+	return true;
+}
+
+
+bool INIReader::writeCache(const char *cacheName, const CacheStamp &stamp) const {
+	// the stamp only describes one file, so changes to included files would
+	// go unnoticed
+	if (!success() || m_contents->hasIncludes) {
+		return false;
+	}
+
+	CacheHeader header{};
+	std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.fieldSize = sizeof(CacheField);
+	header.options = CACHE_OPTIONS;
+	header.sourceSize = stamp.size;
+	header.sourceTime = stamp.time;
+	header.sourceHash = stamp.hash;
+
+	std::vector<CacheSection> sections;
+	std::vector<CacheField> fields;
+	std::string text;
+
+	for (const std::string_view &name : getSectionNames()) {
+		const std::uint32_t sectionIdx = static_cast<std::uint32_t>(sections.size());
+		sections.push_back(CacheSection{ text.length(), name.length() });
+		text.append(name);
+
+		// fields are stored in the order they are kept in, by section and key
+		for (const Field &field : tryGetSectionFields(name)) {
+			CacheField record{};
+			record.hash = FieldIndex::hash(name, field.key);
+			record.section = sectionIdx;
+			record.keyOffset = text.length();
+			record.keyLength = static_cast<std::uint32_t>(field.key.length());
+			text.append(field.key);
+			record.valueOffset = text.length();
+			record.valueLength = static_cast<std::uint32_t>(field.value.length());
+			text.append(field.value);
+			record.typed = field.typed;
+			fields.push_back(record);
+		}
+	}
+
+	header.sectionCount = sections.size();
+	header.fieldCount = fields.size();
+	header.textSize = text.length();
+
+	std::string out;
+	out.reserve(sizeof(header) + sections.size() * sizeof(CacheSection) + fields.size() * sizeof(CacheField) + text.length());
+	out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.append(reinterpret_cast<const char *>(sections.data()), sections.size() * sizeof(CacheSection));
+	out.append(reinterpret_cast<const char *>(fields.data()), fields.size() * sizeof(CacheField));
+	out.append(text);
+
+	return replaceFile(cacheName, out);
+}
+
+
+INIReader INIReader::fromCache(const char *fileName, const char *cacheName) {
+	START_LOAD();
+	INIReader reader;
+	CacheStamp stamp;
+
+	// read the time before the contents, so that a change made in between
+	// leaves a cache that is out of date rather than one that is wrong
+	const bool hasTime = modificationTime(fileName, stamp.time);
+	const MappedFile source(fileName);
+
+	if (!hasTime || !source.isOpen()) {
+		reader.m_contents = std::make_shared<Contents>(0);
+		reader.m_error = ErrorCode::NoSuchFile;
+		reader.m_contents->finish();
+		return reader;
+	}
+
+	stamp.size = source.data().length();
+	stamp.hash = hashBytes(source.data());
+
+	if (reader.readCache(cacheName, stamp)) {
+		FINISH_LOAD(*reader.m_contents);
+		return reader;
+	}
+
+	// parse a copy of the text that was hashed, so the new cache matches it
+	// exactly and the reader does not depend on the source file once loaded
+	// (unlike the cache, it may be edited in place at any time)
+	reader.m_contents = std::make_shared<Contents>(source.data().length());
+	reader.m_contents->buffer.assign(source.data());
+	reader.readInPlace(reader.m_contents->buffer);
+	reader.readIncludes(fileName, nullptr, 0);
+	reader.m_contents->finish();
+	FINISH_LOAD(*reader.m_contents);
+
+	reader.writeCache(cacheName, stamp);
+	return reader;
+}
+
+
+bool INIReader::saveCache(const char *fileName, const char *cacheName) const {
+	CacheStamp stamp;
+
+	if (!modificationTime(fileName, stamp.time)) {
+		return false;
+	}
+
+	const MappedFile source(fileName);
+
+	if (!source.isOpen()) {
+		return false;
+	}
+
+	stamp.size = source.data().length();
+	stamp.hash = hashBytes(source.data());
+
+	return writeCache(cacheName, stamp);
+}
+
+
+const bool INIReader::success() const {
+	return m_error == ErrorCode::None;
+}
+
+
+const LoadStats &INIReader::getLoadStats() const {
+#if COLLECT_LOAD_STATS
+	return m_contents->stats;
+#else
+	static const LoadStats none;
+	return none;
+#endif
+}
+
+
+INIReader::FieldRange INIReader::getSectionFields(std::string_view section) const {
+	const FieldRange fields = tryGetSectionFields(section);
+
+	// sections are only stored once they have a field
+	if (fields.empty()) {
+		throw std::out_of_range("No fields found for section.");
+	}
+
+	return fields;
+}
+
+
+INIReader::FieldRange INIReader::tryGetSectionFields(std::string_view section) const noexcept {
+#if USE_FLAT_STORAGE
+	const auto &sections = m_contents->sections;
+	const auto found = std::lower_bound(
+		sections.begin(),
+		sections.end(),
+		section,
+		[](const Section &sec, std::string_view name) { return sec.name < name; }
+	);
+
+	if (found == sections.end() || found->name != section) {
+		return FieldRange();
+	}
+
+	const Field *fields = m_contents->fields.data();
+	return FieldRange(fields + found->first, fields + found->last);
+#else
+	const auto found = m_contents->lookup.find(section);
+
+	if (found == m_contents->lookup.end()) {
+		return FieldRange();
+	}
+
+	return FieldRange(found->second.begin(), found->second.end());
+#endif
+}
+
+
+const std::string INIReader::getString(
+	std::string_view section,
+	std::string_view key,
+	std::string_view defValue
+) const {
+	return std::string(getStringView(section, key, defValue));
+}
+
+
+std::string_view INIReader::getStringView(
+	std::string_view section,
+	std::string_view key,
+	std::string_view defValue
+) const {
+	const Field *field = getField(section, key, FieldIndex::hash(section, key));
+	return field ? field->value : defValue;
+}
+
+
+/**
+ * @brief Converts a string to a number with `std::from_chars`, which unlike
+ * `std::stoi` and friends does not accept a leading `+`, so that is skipped
+ * here.
+ */
+template <typename T, typename... Format>
+static Conversion<T> fromChars(std::string_view str, Format... format) {
+	Conversion<T> result;
+
+	if (str.empty()) {
+		result.error = ConversionError::MissingValue;
+		return result;
+	}
+
+	const char *first = str.data();
+	const char *last = str.data() + str.length();
+
+	// a sign is allowed, but not a sign followed by another sign
+	if (*first == '+' && last - first > 1 && first[1] != '-') {
+		++first;
+	}
+
+	const std::from_chars_result res = std::from_chars(first, last, result.value, format...);
+
+	if (res.ec == std::errc::result_out_of_range) {
+		result.error = ConversionError::OutOfRange;
+	} else if (res.ec != std::errc() || res.ptr != last) {
+		result.error = ConversionError::InvalidFormat;
+	}
+
+	return result;
+}
+
+
+template <>
+Conversion<int> INIReader::convert<int>(std::string_view str) {
+	return fromChars<int>(str, 10);
+}
+
+
+template <>
+Conversion<long> INIReader::convert<long>(std::string_view str) {
+	return fromChars<long>(str, 10);
+}
+
+
+template <>
+Conversion<long long> INIReader::convert<long long>(std::string_view str) {
+	return fromChars<long long>(str, 10);
+}
+
+
+template <>
+Conversion<double> INIReader::convert<double>(std::string_view str) {
+	return fromChars<double>(str, std::chars_format::general);
+}
+
+
+template <>
+Conversion<bool> INIReader::convert<bool>(std::string_view str) {
+	Conversion<bool> result;
+
+	if (str.empty()) {
+		result.error = ConversionError::MissingValue;
+	} else if (equalsIgnoreCase(str, "true") || equalsIgnoreCase(str, "yes") || equalsIgnoreCase(str, "on") || str == "1") {
+		result.value = true;
+	} else if (equalsIgnoreCase(str, "false") || equalsIgnoreCase(str, "no") || equalsIgnoreCase(str, "off") || str == "0") {
+		result.value = false;
+	} else {
+		result.error = ConversionError::InvalidFormat;
+	}
+
+	return result;
+}
+
+
+const int INIReader::getInt(
+	std::string_view section,
+	std::string_view key,
+	const int defValue
+) const {
+	return tryGetInt(section, key).valueOr(defValue);
+}
+
+
+const long INIReader::getLong(
+	std::string_view section,
+	std::string_view key,
+	const long defValue
+) const {
+	return tryGetLong(section, key).valueOr(defValue);
+}
+
+
+const double INIReader::getDouble(
+	std::string_view section,
+	std::string_view key,
+	const double defValue
+) const {
+	return tryGetDouble(section, key).valueOr(defValue);
+}
+
+
+const bool INIReader::getBool(
+	std::string_view section,
+	std::string_view key,
+	const bool defValue
+) const {
+	return tryGetBool(section, key).valueOr(defValue);
+}
+
+
+TypedValue INIReader::convertAll(std::string_view str) {
+	TypedValue typed;
+
+	const Conversion<long long> integer = convert<long long>(str);
+	typed.integer = integer.value;
+	typed.integerError = integer.error;
+
+	const Conversion<double> real = convert<double>(str);
+	typed.real = real.value;
+	typed.realError = real.error;
+
+	const Conversion<bool> boolean = convert<bool>(str);
+	typed.boolean = boolean.value;
+	typed.booleanError = boolean.error;
+
+	return typed;
+}
+
+
+#if COUNT_KEY_ACCESSES
+/**
+ * @brief The id of the next access counter to be created.
+ */
+static std::atomic<std::uint64_t> nextCounterId{ 1 };
+
+
+AccessCounter::AccessCounter() : m_id(nextCounterId.fetch_add(1, std::memory_order_relaxed)) {}
+
+
+AccessCounter::Shard &AccessCounter::shard() {
+	// the shard of every counter this thread has used, with the last one
+	// checked first, so that reading from several readers in turn stays
+	// free of locks
+	thread_local std::uint64_t lastId = 0;
+	thread_local Shard *last = nullptr;
+	thread_local std::unordered_map<std::uint64_t, Shard *> known;
+
+	if (lastId == m_id) {
+		return *last;
+	}
+
+	auto found = known.find(m_id);
+
+	if (found == known.end()) {
+		// counters that no longer exist leave entries behind, so start over
+		// once there are many (the live ones are found again below)
+		if (known.size() >= 64) {
+			known.clear();
+		}
+
+		found = known.emplace(m_id, &addShard()).first;
+	}
+
+	lastId = m_id;
+	last = found->second;
+	return *last;
+}
+
+
+AccessCounter::Shard &AccessCounter::addShard() {
+	const std::thread::id self = std::this_thread::get_id();
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto found = std::find_if(m_shards.begin(), m_shards.end(), [&](const auto &entry) { return entry.first == self; });
+
+	if (found == m_shards.end()) {
+		m_shards.emplace_back(self, std::make_unique<Shard>());
+		found = std::prev(m_shards.end());
+	}
+
+	return *found->second;
+}
+
+
+AccessCounter::Counts &AccessCounter::counts(Shard &shard, std::string_view section, std::string_view key, std::uint64_t hash) {
+	// keys with the same hash take the next free value after it
+	for (;; ++hash) {
+		const auto found = shard.keys.find(hash);
+
+		if (found == shard.keys.end()) {
+			break;
+		}
+
+		if (found->second.section == section && found->second.key == key) {
+			return found->second;
+		}
+	}
+
+	// only this thread adds keys, so finding them above needs no lock
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	Counts &counts = shard.keys[hash];
+	counts.section = section;
+	counts.key = key;
+	return counts;
+}
+
+
+void AccessCounter::record(std::string_view section, std::string_view key, const std::uint64_t hash, const bool hit) {
+	Counts &read = counts(shard(), section, key, hash);
+	std::atomic<std::uint64_t> &count = hit ? read.hits : read.misses;
+
+	// only this thread writes to the count, so it need not be added to atomically
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+std::vector<KeyAccess> AccessCounter::collect() const {
+	std::map<std::pair<std::string_view, std::string_view>, KeyAccess> totals;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (const auto &entry : m_shards) {
+		std::lock_guard<std::mutex> shardLock(entry.second->mutex);
+
+		for (const auto &key : entry.second->keys) {
+			KeyAccess &total = totals[{ key.second.section, key.second.key }];
+			total.hits += key.second.hits.load(std::memory_order_relaxed);
+			total.misses += key.second.misses.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::vector<KeyAccess> accesses;
+	accesses.reserve(totals.size());
+
+	for (auto &entry : totals) {
+		entry.second.section = entry.first.first;
+		entry.second.key = entry.first.second;
+		accesses.push_back(std::move(entry.second));
+	}
+
+	// keys read equally often stay ordered by section and key
+	std::stable_sort(accesses.begin(), accesses.end(), [](const KeyAccess &a, const KeyAccess &b) {
+		return a.hits + a.misses > b.hits + b.misses;
+	});
+
+	return accesses;
+}
+#endif
+
+
+std::vector<KeyAccess> INIReader::getKeyAccesses() const {
+#if COUNT_KEY_ACCESSES
+	return m_contents->accesses.collect();
+#else
+	return std::vector<KeyAccess>();
+#endif
+}
+
+
+const Field *INIReader::getField(std::string_view section, std::string_view key, const std::uint64_t hash) const {
+	const Field *field = m_contents->index.find(section, key, hash);
+
+	// empty values are treated as missing
+	if (field && field->value.empty()) {
+		field = nullptr;
+	}
+
+#if COUNT_KEY_ACCESSES
+	m_contents->accesses.record(section, key, hash, field != nullptr);
+#endif
+
+	return field;
+}
+
+
+const TypedValue *INIReader::getTyped(std::string_view section, std::string_view key) const {
+	return getTyped(getField(section, key, FieldIndex::hash(section, key)));
+}
+
+
+const TypedValue *INIReader::getTyped(const Field *field) const {
+	if (!field) {
+		return nullptr;
+	}
+
+#if COUNT_CACHED_CONVERSIONS
+	m_contents->cachedConversions.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	return &field->typed;
+}
+
+
+/**
+ * @brief Narrows a converted integer to the type `T`.
+ */
+template <typename T>
+static Conversion<T> narrow(const TypedValue *typed) {
+	Conversion<T> result;
+
+	if (!typed) {
+		result.error = ConversionError::MissingValue;
+	} else if (typed->integerError != ConversionError::None) {
+		result.error = typed->integerError;
+	} else if (typed->integer < std::numeric_limits<T>::min() || typed->integer > std::numeric_limits<T>::max()) {
+		result.error = ConversionError::OutOfRange;
+	} else {
+		result.value = static_cast<T>(typed->integer);
+	}
+
+	return result;
+}
+
+
+Conversion<int> INIReader::tryGetInt(std::string_view section, std::string_view key) const {
+	return narrow<int>(getTyped(section, key));
+}
+
+
+Conversion<long> INIReader::tryGetLong(std::string_view section, std::string_view key) const {
+	return narrow<long>(getTyped(section, key));
+}
+
+
+Conversion<double> INIReader::tryGetDouble(std::string_view section, std::string_view key) const {
+	const TypedValue *typed = getTyped(section, key);
+
+	Conversion<double> result;
+	if (!typed) {
+		result.error = ConversionError::MissingValue;
+	} else {
+		result.value = typed->real;
+		result.error = typed->realError;
+	}
+
+	return result;
+}
+
+
+Conversion<bool> INIReader::tryGetBool(std::string_view section, std::string_view key) const {
+	const TypedValue *typed = getTyped(section, key);
+
+	Conversion<bool> result;
+	if (!typed) {
+		result.error = ConversionError::MissingValue;
+	} else {
+		result.value = typed->boolean;
+		result.error = typed->booleanError;
+	}
+
+	return result;
+}
+
+
+template <>
+Conversion<int> INIReader::tryGet<int>(const Setting<int> &setting) const {
+	return narrow<int>(getTyped(getField(setting.section, setting.key, setting.hash)));
+}
+
+
+template <>
+Conversion<long> INIReader::tryGet<long>(const Setting<long> &setting) const {
+	return narrow<long>(getTyped(getField(setting.section, setting.key, setting.hash)));
+}
+
+
+template <>
+Conversion<double> INIReader::tryGet<double>(const Setting<double> &setting) const {
+	const TypedValue *typed = getTyped(getField(setting.section, setting.key, setting.hash));
+
+	Conversion<double> result;
+	if (!typed) {
+		result.error = ConversionError::MissingValue;
+	} else {
+		result.value = typed->real;
+		result.error = typed->realError;
+	}
+
+	return result;
+}
+
+
+template <>
+Conversion<bool> INIReader::tryGet<bool>(const Setting<bool> &setting) const {
+	const TypedValue *typed = getTyped(getField(setting.section, setting.key, setting.hash));
+
+	Conversion<bool> result;
+	if (!typed) {
+		result.error = ConversionError::MissingValue;
+	} else {
+		result.value = typed->boolean;
+		result.error = typed->booleanError;
+	}
+
+	return result;
+}
+
+
+template <>
+Conversion<std::string_view> INIReader::tryGet<std::string_view>(const Setting<std::string_view> &setting) const {
+	const Field *field = getField(setting.section, setting.key, setting.hash);
+
+	Conversion<std::string_view> result;
+	if (!field) {
+		result.error = ConversionError::MissingValue;
+	} else {
+		result.value = field->value;
+	}
+
+	return result;
+}
+
+
+/**
+ * @brief Reads the value of a field as the type of a lookup.
+ * @param field The field, or `nullptr` if there is no non-empty value.
+ * @param typed The converted value of the field (only used for lookups
+ * that are not strings).
+ */
+static void resolveLookup(const Lookup &lookup, const Field *field, const TypedValue *typed, LookupResult &result) {
+	result.value = lookup.defaultValue;
+	result.error = ConversionError::None;
+
+	if (!field) {
+		result.error = ConversionError::MissingValue;
+		return;
+	}
+
+	switch (lookup.type) {
+		case LookupType::String:
+			result.value.string = field->value;
+			break;
+		case LookupType::Int: {
+			const Conversion<int> value = narrow<int>(typed);
+			result.error = value.error;
+			if (value.ok()) {
+				result.value.integer = value.value;
+			}
+			break;
+		}
+		case LookupType::Long: {
+			const Conversion<long> value = narrow<long>(typed);
+			result.error = value.error;
+			if (value.ok()) {
+				result.value.integer = value.value;
+			}
+			break;
+		}
+		case LookupType::Double:
+			result.error = typed->realError;
+			if (result.error == ConversionError::None) {
+				result.value.real = typed->real;
+			}
+			break;
+		case LookupType::Bool:
+			result.error = typed->booleanError;
+			if (result.error == ConversionError::None) {
+				result.value.boolean = typed->boolean;
+			}
+			break;
+	}
+}
+
+
+void INIReader::getMany(const Lookup *lookups, const std::size_t count, LookupResult *results) const {
+	constexpr std::size_t group = 16;
+	std::uint64_t hashes[group];
+
+	std::string_view section;
+	std::uint64_t sectionHash = FieldIndex::hashSection(section);
+
+	for (std::size_t first = 0; first < count; first += group) {
+		const std::size_t size = std::min(group, count - first);
+
+		// hash every lookup in the group and start loading its slot
+		for (std::size_t i = 0; i < size; ++i) {
+			const Lookup &lookup = lookups[first + i];
+
+			if (lookup.section != section) {
+				section = lookup.section;
+				sectionHash = FieldIndex::hashSection(section);
+			}
+
+			hashes[i] = FieldIndex::hashKey(sectionHash, lookup.key);
+			m_contents->index.prefetch(hashes[i]);
+		}
+
+		// by now the first slots have arrived
+		for (std::size_t i = 0; i < size; ++i) {
+			const Lookup &lookup = lookups[first + i];
+			const Field *field = getField(lookup.section, lookup.key, hashes[i]);
+			const TypedValue *typed = (lookup.type == LookupType::String) ? nullptr : getTyped(field);
+			resolveLookup(lookup, field, typed, results[first + i]);
+		}
+	}
+}
+
+
+INIWriter::INIWriter(std::string &out) : m_sink(Sink::String), m_string(&out) {}
+
+
+INIWriter::INIWriter(std::ostream &out) : m_sink(Sink::Stream), m_stream(&out), m_buffer(new char[BUFFER_SIZE]) {}
+
+
+INIWriter::INIWriter(const int fd) : m_sink(Sink::Descriptor), m_fd(fd), m_buffer(new char[BUFFER_SIZE]) {
+#if !HAS_MMAP
+	// file descriptors can only be written to on POSIX systems
+	m_failed = true;
+#endif
+}
+
+
+INIWriter::INIWriter(const char *fileName) :
+	m_sink(Sink::Descriptor),
+	m_file_name(fileName),
+	m_temp_name(tempFileName(fileName)),
+	m_buffer(new char[BUFFER_SIZE])
+{
+#if HAS_MMAP
+	m_fd = ::open(m_temp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	m_failed = m_fd < 0;
+
+	// keep the permissions of the file being replaced
+	struct stat info;
+	if (m_fd >= 0 && ::stat(fileName, &info) == 0) {
+		::fchmod(m_fd, info.st_mode & 07777);
+	}
+#else
+	m_sink = Sink::Stream;
+	m_owned_stream = std::make_unique<std::ofstream>(m_temp_name, std::ios::binary | std::ios::trunc);
+	m_stream = m_owned_stream.get();
+	m_failed = m_stream->fail();
+#endif
+}
+
+
+INIWriter::~INIWriter() {
+	if (m_temp_name.empty()) {
+		flush();
+		return;
+	}
+
+	// the file was not committed, so leave the original in place
+#if HAS_MMAP
+	if (m_fd >= 0) {
+		::close(m_fd);
+	}
+#else
+	m_owned_stream.reset();
+#endif
+	std::remove(m_temp_name.c_str());
+}
+
+
+void INIWriter::emit(const char *data, std::size_t length) {
+	if (m_sink == Sink::Stream) {
+		if (!m_stream->write(data, static_cast<std::streamsize>(length))) {
+			m_failed = true;
+		}
+		return;
+	}
+
+#if HAS_MMAP
+	while (length > 0) {
+		const ssize_t written = ::write(m_fd, data, length);
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			m_failed = true;
+			return;
+		}
+
+		data += written;
+		length -= static_cast<std::size_t>(written);
+	}
+#endif
+}
+
+
+char *INIWriter::space(const std::size_t length) {
+	// strings grow on their own, so buffering them would only copy twice
+	if (m_sink == Sink::String) {
+		const std::size_t used = m_string->length();
+		m_string->resize(used + length);
+		return &(*m_string)[used];
+	}
+
+	if (length > BUFFER_SIZE - m_used) {
+		flush();
+
+		if (length > BUFFER_SIZE) {
+			return nullptr;
+		}
+	}
+
+	char *at = m_buffer.get() + m_used;
+	m_used += length;
+	return at;
+}
+
+
+void INIWriter::writeLine(std::string_view a, std::string_view b, std::string_view c, std::string_view d) {
+	char *at = space(a.length() + b.length() + c.length() + d.length());
+
+	// lines that would not fit in the buffer are passed straight on
+	if (!at) {
+		for (const std::string_view part : { a, b, c, d }) {
+			emit(part.data(), part.length());
+		}
+		return;
+	}
+
+	// copying an empty part is fine even when its data is null, unlike `memcpy`
+	for (const std::string_view part : { a, b, c, d }) {
+		at = std::copy(part.begin(), part.end(), at);
+	}
+}
+
+
+bool INIWriter::flush() {
+	if (m_used > 0) {
+		emit(m_buffer.get(), m_used);
+		m_used = 0;
+	}
+
+	return !m_failed;
+}
+
+
+bool INIWriter::commit() {
+	flush();
+
+	if (m_temp_name.empty()) {
+		if (m_sink == Sink::Stream && !m_stream->flush()) {
+			m_failed = true;
+		}
+		return !m_failed;
+	}
+
+	std::string temp;
+	temp.swap(m_temp_name);
+
+	// make the new contents durable before they can replace the old ones
+#if HAS_MMAP
+	if (::fsync(m_fd) != 0 || ::close(m_fd) != 0) {
+		m_failed = true;
+	}
+	m_fd = -1;
+#else
+	if (!m_stream->flush()) {
+		m_failed = true;
+	}
+	m_owned_stream.reset();
+	m_stream = nullptr;
+#endif
+
+	if (!m_failed) {
+		std::error_code error;
+		std::filesystem::rename(temp, m_file_name, error);
+		m_failed = static_cast<bool>(error);
+	}
+
+	if (m_failed) {
+		std::remove(temp.c_str());
+	}
+
+	return !m_failed;
+}
+
+
+/**
+ * @brief Characters that change how a key or value is read back.
+ */
+enum WriteClass : unsigned char {
+	LineBreak = 1,
+	CommentPrefix = 2,
+	Equals = 4,
+	CloseBracket = 8
+};
+
+/**
+ * @brief The classes of every byte, so that text is checked in one pass.
+ */
+struct WriteTable {
+	unsigned char classes[256]{};
+};
+
+static constexpr WriteTable makeWriteTable() {
+	WriteTable table;
+	table.classes[static_cast<unsigned char>('\n')] = LineBreak;
+	table.classes[static_cast<unsigned char>('\r')] = LineBreak;
+	table.classes[static_cast<unsigned char>('=')] = Equals;
+	table.classes[static_cast<unsigned char>(']')] = CloseBracket;
+
+	const char prefixes[] = START_COMMENT_PREFIXES;
+	for (std::size_t i = 0; i + 1 < sizeof(prefixes); ++i) {
+		table.classes[static_cast<unsigned char>(prefixes[i])] |= CommentPrefix;
+	}
+
+	return table;
+}
+
+static constexpr WriteTable writeTable = makeWriteTable();
+
+/**
+ * @returns The classes of all the characters in `str`, combined.
+ */
+static unsigned classify(std::string_view str) {
+	unsigned classes = 0;
+
+	for (std::size_t i = 0; i < str.length(); ++i) {
+		classes |= writeTable.classes[static_cast<unsigned char>(str[i])];
+	}
+
+	return classes;
+}
+
+
+bool INIWriter::section(std::string_view name) {
+	if ((classify(name) & (LineBreak | CloseBracket)) || (!name.empty() && isWhitespace(name.back()))) {
+		m_failed = true;
+		return false;
+	}
+
+	// separate sections with a blank line
+	writeLine(m_has_section ? "\n[" : "[", name, "]\n");
+	m_has_section = true;
+	return true;
+}
+
+
+/**
+ * @returns `true` if a line starting with `key` would be read as an include
+ * directive instead of a key-value pair.
+ */
+static bool readsAsInclude(std::string_view key) {
+#if ALLOW_INCLUDES
+	const std::string_view directive(INCLUDE_DIRECTIVE);
+
+	return key.substr(0, directive.length()) == directive
+		&& (key.length() == directive.length() || key[directive.length()] == ' ' || key[directive.length()] == '\t');
+#else
+	static_cast<void>(key);
+	return false;
+#endif
+}
+
+
+bool INIWriter::field(std::string_view key, std::string_view value) {
+	const bool validKey = !(classify(key) & (LineBreak | Equals)) && !readsAsInclude(key)
+		&& (key.empty() || (key.front() != '[' && !(writeTable.classes[static_cast<unsigned char>(key.front())] & CommentPrefix)
+			&& !isWhitespace(key.front()) && !isWhitespace(key.back())));
+
+	// surrounding whitespace is always removed, even inside quotes
+	const unsigned classes = classify(value);
+	const bool validValue = !(classes & LineBreak) && (value.empty() || !isWhitespace(value.back()));
+
+	// keys outside a section are an error
+	if (!m_has_section || !validKey || !validValue) {
+		m_failed = true;
+		return false;
+	}
+
+	// quote values the parser would otherwise change: empty values are an
+	// error, leading whitespace is removed, a leading quote starts a quoted
+	// value and a comment prefix starts a comment
+	const bool quoted = value.empty() || value.front() == '"' || isWhitespace(value.front()) || (classes & CommentPrefix);
+
+	// the last quote on the line closes the value, so quotes inside it need
+	// no escaping
+	if (quoted) {
+		writeLine(key, " = \"", value, "\"\n");
+	} else {
+		writeLine(key, " = ", value, "\n");
+	}
+
+	return true;
+}
+
+
+bool INIWriter::field(std::string_view key, const long long value) {
+	char text[24];
+	const auto result = std::to_chars(text, text + sizeof(text), value);
+	return field(key, std::string_view(text, static_cast<std::size_t>(result.ptr - text)));
+}
+
+
+bool INIWriter::field(std::string_view key, const double value) {
+	// the shortest text that converts back to exactly the same value
+	char text[32];
+	const auto result = std::to_chars(text, text + sizeof(text), value);
+	return field(key, std::string_view(text, static_cast<std::size_t>(result.ptr - text)));
+}
+
+
+bool INIWriter::field(std::string_view key, const bool value) {
+	return field(key, value ? std::string_view("true") : std::string_view("false"));
+}
+
+
+bool INIWriter::comment(std::string_view text) {
+	const std::string_view prefixes(START_COMMENT_PREFIXES);
+
+	if (prefixes.empty() || (classify(text) & LineBreak)) {
+		m_failed = true;
+		return false;
+	}
+
+	writeLine(prefixes.substr(0, 1), text, "\n");
+	return true;
+}
+
+
+bool INIWriter::write(const INIReader &reader) {
+	bool written = true;
+
+	for (const std::string_view &name : reader.getSectionNames()) {
+		const INIReader::FieldRange fields = reader.tryGetSectionFields(name);
+
+		// sections without fields cannot be read back
+		if (fields.empty()) {
+			continue;
+		}
+
+		written = section(name) && written;
+
+		for (const Field &entry : fields) {
+			written = field(entry.key, entry.value) && written;
+		}
+	}
+
+	return written;
+}
+
+
+INIHolder::INIHolder(Snapshot initial) : m_current(std::move(initial)) {}
+
+
+void INIHolder::publish(Snapshot next) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_current = next;
+
+	// leave a copy for every handle, replacing any it has not picked up yet
+	for (Slot *slot : m_slots) {
+		delete slot->mailbox.exchange(new Snapshot(next), std::memory_order_acq_rel);
+	}
+}
+
+
+INIHolder::Snapshot INIHolder::load() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_current;
+}
+
+
+INIHolder::Handle::Handle(INIHolder &holder) : m_holder(holder), m_slot(new Slot) {
+	std::lock_guard<std::mutex> lock(m_holder.m_mutex);
+	m_snapshot = m_holder.m_current;
+	m_holder.m_slots.push_back(m_slot.get());
+}
+
+
+INIHolder::Handle::~Handle() {
+	{
+		std::lock_guard<std::mutex> lock(m_holder.m_mutex);
+		m_holder.m_slots.erase(std::find(m_holder.m_slots.begin(), m_holder.m_slots.end(), m_slot.get()));
+	}
+
+	// nothing can be delivered any more
+	delete m_slot->mailbox.load(std::memory_order_acquire);
+}
+
+INIWatcher::INIWatcher(std::string fileName, const LoadMode mode, const std::chrono::milliseconds debounce, const std::chrono::milliseconds maxDelay)
+	: m_file_name(std::move(fileName)),
+	  m_mode(mode),
+	  m_debounce(debounce),
+	  m_max_delay(maxDelay.count() > 0 ? maxDelay : debounce * 10),
+	  m_holder(std::make_shared<const INIReader>(m_file_name.c_str(), m_mode)) {
+	m_error = m_holder.load()->getError();
+
+#if HAS_INOTIFY
+	m_inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	m_wake = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (m_inotify < 0 || m_wake < 0) {
+		return;
+	}
+
+	// watch the directory for files renamed over (or created as) the watched file
+	const std::size_t slash = m_file_name.rfind('/');
+	const std::string dir = (slash == std::string::npos) ? "." : m_file_name.substr(0, slash + 1);
+	m_dir_watch = ::inotify_add_watch(m_inotify, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+
+	watchFile();
+	watchIncludes();
+	m_thread = std::thread(&INIWatcher::run, this);
+#endif
+}
+
+
+INIWatcher::~INIWatcher() {
+#if HAS_INOTIFY
+	if (m_thread.joinable()) {
+		const std::uint64_t stop = 1;
+		while (::write(m_wake, &stop, sizeof(stop)) < 0 && errno == EINTR) {}
+		m_thread.join();
+	}
+
+	if (m_inotify >= 0) {
+		::close(m_inotify);
+	}
+
+	if (m_wake >= 0) {
+		::close(m_wake);
+	}
+#endif
+}
+
+
+bool INIWatcher::isWatching() const {
+	return m_thread.joinable();
+}
+
+
+std::shared_ptr<const INIReader> INIWatcher::current() const {
+	return m_holder.load();
+}
+
+
+const std::string INIWatcher::getError() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_error;
+}
+
+
+bool INIWatcher::reload() {
+	std::lock_guard<std::mutex> reloading(m_reload_mutex);
+
+	// parse without holding the lock, so readers are never kept waiting
+	const auto next = std::make_shared<const INIReader>(m_file_name.c_str(), m_mode);
+	std::vector<Subscription> subscriptions;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_error = next->getError();
+
+		// keep the last configuration that was parsed successfully
+		if (!next->success()) {
+			return false;
+		}
+
+		subscriptions = m_subscriptions;
+	}
+
+	const auto previous = m_holder.load();
+	m_holder.publish(next);
+
+	// only tell subscribers about what actually changed
+	for (const auto &subscription : subscriptions) {
+		if (subscription.key.empty()) {
+			const auto before = previous->tryGetSectionFields(subscription.section);
+			const auto after = next->tryGetSectionFields(subscription.section);
+
+			if (!std::equal(before.begin(), before.end(), after.begin(), after.end())) {
+				subscription.callback(*previous, *next, subscription.section, "");
+			}
+		} else {
+			const std::string_view before = previous->getStringView(subscription.section, subscription.key, "");
+			const std::string_view after = next->getStringView(subscription.section, subscription.key, "");
+
+			if (before != after) {
+				subscription.callback(*previous, *next, subscription.section, subscription.key);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+void INIWatcher::onSectionChange(std::string section, ChangeCallback callback) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_subscriptions.push_back(Subscription{ std::move(section), std::string(), std::move(callback) });
+}
+
+
+void INIWatcher::onKeyChange(std::string section, std::string key, ChangeCallback callback) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_subscriptions.push_back(Subscription{ std::move(section), std::move(key), std::move(callback) });
+}
+
+
+void INIWatcher::run() {
+#if HAS_INOTIFY
+	pollfd fds[2]{
+		{ m_inotify, POLLIN, 0 },
+		{ m_wake, POLLIN, 0 }
+	};
+
+	while (true) {
+		if (::poll(fds, 2, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+
+		// asked to stop
+		if (fds[1].revents) {
+			return;
+		}
+
+		if (!drainEvents()) {
+			continue;
+		}
+
+		// wait until the file has been quiet for a while, so that a burst of
+		// writes is only parsed once, but no longer than the maximum delay so
+		// that a file which keeps changing is still reloaded
+		const auto deadline = std::chrono::steady_clock::now() + m_max_delay;
+		for (;;) {
+			const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+			if (left.count() <= 0) {
+				break;
+			}
+
+			const int ready = ::poll(fds, 2, static_cast<int>(std::min(m_debounce, left).count()));
+			if (ready == 0) {
+				break;
+			}
+
+			if (ready < 0 && errno != EINTR) {
+				return;
+			}
+
+			if (ready > 0 && fds[1].revents) {
+				return;
+			}
+
+			drainEvents();
+		}
+
+		watchFile();
+		reload();
+		watchIncludes();
+	}
+#endif
+}
+
+
+bool INIWatcher::drainEvents() {
+	bool relevant{ false };
+
+#if HAS_INOTIFY
+	const std::size_t slash = m_file_name.rfind('/');
+	const std::string_view base = std::string_view(m_file_name).substr(slash == std::string::npos ? 0 : slash + 1);
+
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+
+	while ((length = ::read(m_inotify, buffer, sizeof(buffer))) > 0) {
+		for (ssize_t offset = 0; offset < length; ) {
+			const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+			// events in the directory are only relevant if they are about the
+			// file, but any change where files are included from is
+			if (event->wd == m_file_watch || (event->wd == m_dir_watch && event->len > 0 && base == event->name)
+				|| std::find(m_include_watches.begin(), m_include_watches.end(), event->wd) != m_include_watches.end()) {
+				relevant = true;
+			}
+		}
+	}
+#endif
+
+	return relevant;
+}
+
+
+void INIWatcher::watchIncludes() {
+#if HAS_INOTIFY
+	std::vector<int> watches;
+
+	for (const std::string &directory : m_holder.load()->getIncludeDirectories()) {
+		// IN_MASK_ADD keeps the events already watched for when this is the
+		// directory of the watched file
+		const int watch = ::inotify_add_watch(m_inotify, directory.c_str(),
+			IN_MASK_ADD | IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM);
+
+		if (watch >= 0) {
+			watches.push_back(watch);
+		}
+	}
+
+	for (const int watch : m_include_watches) {
+		if (watch != m_dir_watch && std::find(watches.begin(), watches.end(), watch) == watches.end()) {
+			::inotify_rm_watch(m_inotify, watch);
+		}
+	}
+
+	m_include_watches = std::move(watches);
+#endif
+}
+
+
+void INIWatcher::watchFile() {
+#if HAS_INOTIFY
+	const int watch = ::inotify_add_watch(m_inotify, m_file_name.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF);
+
+	// a new file was renamed over the old one, which no longer matters
+	if (m_file_watch >= 0 && watch != m_file_watch) {
+		::inotify_rm_watch(m_inotify, m_file_watch);
+	}
+
+	m_file_watch = watch;
+#endif
+}
@@ -3,9 +3,26 @@
 #ifndef INI_HPP
 #define INI_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #ifndef ALLOW_MULTILINE
 #	define ALLOW_MULTILINE 1
@@ -35,6 +52,52 @@
 #	endif
 #endif
 
+#ifndef ALLOW_INCLUDES
+#	define ALLOW_INCLUDES 1
+#endif
+
+#if ALLOW_INCLUDES
+#	ifndef INCLUDE_DIRECTIVE
+#		define INCLUDE_DIRECTIVE "!include"
+#	endif
+#endif
+
+#ifndef USE_ARENA_STORAGE
+#	define USE_ARENA_STORAGE 0
+#endif
+
+#ifndef USE_FLAT_STORAGE
+#	define USE_FLAT_STORAGE 0
+#endif
+
+#ifndef COUNT_CACHED_CONVERSIONS
+#	define COUNT_CACHED_CONVERSIONS 0
+#endif
+
+#ifndef USE_SIMD_SCAN
+#	define USE_SIMD_SCAN 1
+#endif
+
+#ifndef COLLECT_LOAD_STATS
+#	define COLLECT_LOAD_STATS 0
+#endif
+
+#ifndef COUNT_KEY_ACCESSES
+#	define COUNT_KEY_ACCESSES 0
+#endif
+
+// storage uses polymorphic allocators when it allocates from an arena, or
+// when its allocations are counted
+#define USE_PMR_STORAGE (USE_ARENA_STORAGE || COLLECT_LOAD_STATS)
+
+#if USE_PMR_STORAGE
+#	include <memory_resource>
+#endif
+
+#if COUNT_KEY_ACCESSES
+#	include <unordered_map>
+#endif
+
 #define MAX_SECTION_LENGTH 50
 #define MAX_KEY_LENGTH     50
 #define MAX_LINE_LENGTH    200
@@ -49,7 +112,11 @@ enum class ErrorCode {
 	EmptySection,
 	KeyOutsideSection,
 	NoValueForKey,
-	NoClosingQuotationForValue
+	NoClosingQuotationForValue,
+	NoPathForInclude,
+	NoSuchInclude,
+	IncludeCycle,
+	IncludeNotAllowed
 };
 
 /**
@@ -62,24 +129,136 @@ static const std::string errorStrings[]{
 	"Section has no key-value pairs.",
 	"Key-value pair was found outside a section.",
 	"No value found for key.",
-	"No closing double quotes for value."
+	"No closing double quotes for value.",
+	"No path found for include.",
+	"Included file does not exist.",
+	"File includes itself.",
+	"Include directives are not allowed in this text."
+};
+
+/**
+ * @brief The different reasons a value may fail to convert to a type.
+ */
+enum class ConversionError : std::uint8_t {
+	None,
+	MissingValue,
+	InvalidFormat,
+	OutOfRange
+};
+
+/**
+ * @brief String representations of the conversion errors that can occur.
+ */
+static const std::string conversionErrorStrings[]{
+	"No error has occurred.",
+	"No value found for section and key.",
+	"Value is not in the expected format.",
+	"Value is out of range for the type."
+};
+
+/**
+ * @brief The result of converting a value to the type `T`.
+ */
+template <typename T>
+struct Conversion {
+	// Converted value (only meaningful when `error` is `ConversionError::None`).
+	T value{};
+
+	// Reason the conversion failed, if it did.
+	ConversionError error{ ConversionError::None };
+
+	/**
+	 * @returns `true` if the conversion succeeded, `false` otherwise.
+	 */
+	bool ok() const {
+		return error == ConversionError::None;
+	}
+
+	explicit operator bool() const {
+		return ok();
+	}
+
+	/**
+	 * @returns The converted value if the conversion succeeded, else `defValue`.
+	 */
+	T valueOr(const T defValue) const {
+		return ok() ? value : defValue;
+	}
+
+	/**
+	 * @returns A string representation of the error that occurred.
+	 */
+	const std::string &getError() const {
+		return conversionErrorStrings[static_cast<int>(error)];
+	}
+};
+
+/**
+ * @brief The ways in which `INIReader` can load a file.
+ */
+enum class LoadMode {
+	// Read the file line by line, copying the parsed text.
+	Stream,
+
+	// Map the whole file into memory and parse it in place without copying.
+	// The reader keeps the mapping for as long as it lives, so the file must
+	// not be truncated or edited in place meanwhile (which crashes later
+	// reads with `SIGBUS` or changes their results); replace it by renaming
+	// a new file over it instead.
+	Mapped,
+
+	// Map the whole file into memory and parse it in place on several
+	// threads, splitting it at section declarations. The result is exactly
+	// the same as with the other modes, and the file must be left alone in
+	// the same way as with `Mapped`.
+	Parallel
+};
+
+/**
+ * @brief A value converted to each of the supported types, so that typed
+ * reads do not have to parse the value again.
+ */
+struct TypedValue {
+	// Value as an integer (at least 64 bits).
+	long long integer{ 0 };
+
+	// Value as a double-precision floating-point number.
+	double real{ 0.0 };
+
+	// Value as a boolean.
+	bool boolean{ false };
+
+	// Reasons the value could not be converted to each type.
+	ConversionError integerError{ ConversionError::MissingValue };
+	ConversionError realError{ ConversionError::MissingValue };
+	ConversionError booleanError{ ConversionError::MissingValue };
 };
 
 /**
  * @brief Stores the key-value pair of a section entry in the file.
+ *
+ * The key and value are views into text owned by the `INIReader` that
+ * parsed them, so a field is only valid while that reader (or a copy of it)
+ * is alive.
  */
 struct Field {
 	// Key used for lookup (case sensitive).
-	std::string key;
+	std::string_view key;
 
 	// Value associated with key.
-	std::string value;
+	std::string_view value;
+
+	// Value converted to each supported type when the field was parsed.
+	TypedValue typed;
 
 	/**
 	 * @returns The key-value pair as a string in the form `key=value`.
 	 */
 	std::string toString() const {
-		return key + '=' + value;
+		std::string str;
+		str.reserve(key.length() + value.length() + 1);
+		str.append(key).append(1, '=').append(value);
+		return str;
 	}
 
 	bool operator<(const Field &field) const {
@@ -92,214 +271,2353 @@ struct Field {
 };
 
 /**
- * @brief Class that reads a `.ini` file and stores the name-value pairs
- * for easy access.
+ * @brief The fields of a section, ordered by key.
  */
-class INIReader {
+#if USE_FLAT_STORAGE && USE_PMR_STORAGE
+using FieldSet = std::pmr::vector<Field>;
+#elif USE_FLAT_STORAGE
+using FieldSet = std::vector<Field>;
+#elif USE_PMR_STORAGE
+using FieldSet = std::pmr::set<Field>;
+#else
+using FieldSet = std::set<Field>;
+#endif
+
+/**
+ * @brief A read-only view over a range of elements stored by an `INIReader`,
+ * which can be iterated without copying them.
+ */
+template <typename Iterator>
+class Range {
 
 private:
 
 	/**
-	 * @brief The current line number in the file.
+	 * @brief The first element in the range.
 	 */
-	int m_line_num;
+	Iterator m_first{};
 
 	/**
-	 * @brief Keeps track of whether or not the current line is inside a section.
+	 * @brief One past the last element in the range.
 	 */
-	bool m_in_section{ false };
+	Iterator m_last{};
+
+public:
 
 	/**
-	 * @brief The current section (used when `m_in_section` is true).
+	 * @brief Creates an empty range.
 	 */
-	std::string m_curr_section;
+	Range() = default;
 
 	/**
-	 * @brief Keep track of any error that occurs during parsing.
+	 * @brief Creates a range over [`first`, `last`).
 	 */
-	ErrorCode m_error{ ErrorCode::None };
+	Range(Iterator first, Iterator last) : m_first(first), m_last(last) {}
+
+	Iterator begin() const {
+		return m_first;
+	}
+
+	Iterator end() const {
+		return m_last;
+	}
 
 	/**
-	 * @brief Lookup table containing key-values pairs, where the key is the
-	 * name of the section and the values are the fields present in that section.
+	 * @returns `true` if the range has no elements, `false` otherwise.
 	 */
-	std::map<std::string, std::set<Field>> m_lookup;
+	bool empty() const {
+		return m_first == m_last;
+	}
 
 	/**
-	 * @brief Names of all sections present in the given `.ini` file.
+	 * @returns The number of elements in the range.
 	 */
-	std::set<std::string> m_section_names;
+	std::size_t size() const {
+		return static_cast<std::size_t>(std::distance(m_first, m_last));
+	}
+
+};
+
+/**
+ * @brief Open-addressing hash table that maps a (section, key) pair to the
+ * field stored under it, so that a lookup is usually a single probe.
+ *
+ * The table only stores pointers to fields, which must outlive it.
+ */
+class FieldIndex {
+
+private:
 
 	/**
-	 * @brief Removes any leading whitespace (in place).
-	 * @param str The string to remove leading whitespace from.
+	 * @brief An entry in the table. Empty slots have no field.
 	 */
-	void lstrip(std::string &str);
+	struct Slot {
+		std::uint64_t hash{ 0 };
+		std::string_view section;
+		const Field *field{ nullptr };
+	};
 
 	/**
-	 * @brief Removes any trailing whitespace (in place).
-	 * @param str The string to remove trailing whitespace from.
+	 * @brief The slots of the table, the count of which is a power of two.
 	 */
-	void rstrip(std::string &str);
+	std::vector<Slot> m_slots;
 
 	/**
-	 * @brief Removes both leading and trailing whitespace (in place).
-	 * @param str The string to remove leading and trailing whitespace from.
+	 * @brief Number of fields in the table.
 	 */
-	void trim(std::string &str);
+	std::size_t m_size{ 0 };
 
 	/**
-	 * @returns `true` if there are sections with no key-value pairs, `false`
-	 * otherwise.
+	 * @returns The first slot to probe for `hash`.
 	 */
-	bool hasEmptySections();
+	std::size_t home(std::uint64_t hash) const {
+		// the upper bits of the hash are better mixed than the lower ones
+		return static_cast<std::size_t>(hash >> 32) & (m_slots.size() - 1);
+	}
 
 	/**
-	 * @brief Removes comments from a string (in place).
+	 * @brief Resizes the table to `slots` slots and re-inserts every field.
 	 */
-	void removeComment(std::string &str);
+	void rehash(std::size_t slots);
+
+public:
 
 	/**
-	 * @brief Parses a section in a file.
-	 * @param str The string containing the section.
-	 * @returns `true` if no errors occurred, `false` otherwise.
+	 * @brief Hashes the section part of a (section, key) pair, so that it
+	 * can be shared by several keys in the same section.
+	 * @param section The name of the section.
+	 * @returns The state to pass to `hashKey`.
 	 */
-	bool parseSection(const std::string &str);
+	static constexpr std::uint64_t hashSection(std::string_view section) {
+		std::uint64_t h = 14695981039346656037ull;
+
+		for (const char c : section) {
+			h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+		}
+
+		// separate the section from the key so that ("ab", "c") != ("a", "bc")
+		return (h ^ 0xffu) * 1099511628211ull;
+	}
 
 	/**
-	 * @brief Parses a key-value pair inside a section in a file.
-	 * @param k The string containing the key.
-	 * @param v The string containing the value.
-	 * @returns `true` if no errors occurred, `false` otherwise.
+	 * @brief Finishes hashing a (section, key) pair.
+	 * @param sectionHash The result of `hashSection(section)`.
+	 * @param key The key inside the section.
+	 * @returns The hash of the pair.
 	 */
-	bool parsePair(const std::string &k, const std::string &v);
+	static constexpr std::uint64_t hashKey(std::uint64_t sectionHash, std::string_view key) {
+		std::uint64_t h = sectionHash;
+
+		for (const char c : key) {
+			h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+		}
+
+		return h;
+	}
 
 	/**
-	 * @brief Parses a line of the file.
-	 * @param str The current line in the file.
-	 * @returns `true` if no errors occurred, `false` otherwise.
+	 * @brief Hashes a (section, key) pair using 64-bit FNV-1a.
+	 * @param section The name of the section.
+	 * @param key The key inside the section.
+	 * @returns The hash of the pair.
 	 */
-	bool parseLine(const std::string &str);
+	static constexpr std::uint64_t hash(std::string_view section, std::string_view key) {
+		return hashKey(hashSection(section), key);
+	}
 
 	/**
-	 * @brief Gets a string value from the configuration file.
-	 * @param section The name of the section to get the value from.
-	 * @param key The key associated with the value.
-	 * @param defValue The value to return if no such section or key is found.
-	 * @returns The associated value if `key` is found, else `defValue`.
+	 * @brief Starts loading the slot that a lookup of `hash` probes first,
+	 * so that several lookups can wait on memory at the same time.
 	 */
-	const std::string get(
-		const std::string &section,
-		const std::string &key,
-		const std::string &defValue
-	) const;
+	void prefetch(std::uint64_t hash) const {
+#if defined(__GNUC__) || defined(__clang__)
+		if (!m_slots.empty()) {
+			__builtin_prefetch(&m_slots[home(hash)]);
+		}
+#endif
+	}
 
-public:
+	/**
+	 * @brief Removes all fields from the table.
+	 */
+	void clear() {
+		m_slots.clear();
+		m_size = 0;
+	}
 
 	/**
-	 * @brief Initializes the parser to read from a file.
-	 * @param fileName The path of the file to read from.
+	 * @brief Makes room for `count` fields, so that adding them does not
+	 * resize the table again.
 	 */
-	INIReader(const char *fileName);
+	void reserve(std::size_t count);
 
 	/**
-	 * @brief Destructor for the parser.
+	 * @brief Adds a field to the table, unless its key already exists in
+	 * the section.
+	 * @param section The name of the section the field belongs to.
+	 * @param field The field to add.
+	 * @param hash The result of `hash(section, field->key)`.
+	 * @returns `true` if the field was added, `false` otherwise.
 	 */
-	~INIReader() = default;
+	bool insert(std::string_view section, const Field *field, std::uint64_t hash);
 
 	/**
-	 * @brief Check if initialization of INIReader was successful.
-	 * @returns `true` if no error occurred parsing the file, `false` otherwise.
+	 * @brief Adds a field to the table, unless its key already exists in
+	 * the section.
+	 * @param section The name of the section the field belongs to.
+	 * @param field The field to add.
+	 * @returns `true` if the field was added, `false` otherwise.
 	 */
-	const bool success() const;
+	bool insert(std::string_view section, const Field *field) {
+		return insert(section, field, hash(section, field->key));
+	}
 
 	/**
-	 * @brief Gets a string value from the configuration file.
-	 * @param section The name of the section to get the value from.
-	 * @param key The key associated with the value.
-	 * @param defValue The value to return if no such section or key is found.
-	 * @returns The associated value if `key` is found, else `defValue`.
+	 * @brief Looks up the field with the given key in the given section.
+	 * @param section The name of the section.
+	 * @param key The key of the field.
+	 * @param hash The result of `hash(section, key)`.
+	 * @returns The field if found, else `nullptr`.
 	 */
-	const std::string getString(
-		const std::string &section,
-		const std::string &key,
-		const std::string &defValue
-	) const;
+	const Field *find(std::string_view section, std::string_view key, std::uint64_t hash) const;
 
 	/**
-	 * @brief Gets an integer value from the configuration file.
-	 * @param section The name of the section to get the value from.
-	 * @param key The key associated with the value.
-	 * @param defValue The value to return if no such section or key is found.
-	 * @returns The associated value if `key` is found, else `defValue`.
+	 * @brief Looks up the field with the given key in the given section.
+	 * @param section The name of the section.
+	 * @param key The key of the field.
+	 * @returns The field if found, else `nullptr`.
 	 */
-	const int getInt(
-		const std::string &section,
-		const std::string &key,
-		const int defValue
-	) const;
+	const Field *find(std::string_view section, std::string_view key) const {
+		return find(section, key, hash(section, key));
+	}
 
 	/**
-	 * @brief Gets a long value from the configuration file.
-	 * @param section The name of the section to get the value from.
-	 * @param key The key associated with the value.
-	 * @param defValue The value to return if no such section or key is found.
-	 * @returns The associated value if `key` is found, else `defValue`.
+	 * @returns The number of fields in the table.
 	 */
-	const long getLong(
-		const std::string &section,
-		const std::string &key,
-		const long defValue
-	) const;
+	std::size_t size() const {
+		return m_size;
+	}
+
+};
+
+/**
+ * @brief Describes a setting: where it lives, its type and its default.
+ * Declare settings `constexpr` so their hashes are computed at compile time:
+ * ```
+ * constexpr Setting<int> WindowWidth{ "WINDOW", "Width", 800 };
+ * ```
+ * @tparam T The type of the value, which must be `int`, `long`, `double`,
+ * `bool` or `std::string_view`.
+ */
+template <typename T>
+struct Setting {
+	static_assert(
+		std::is_same_v<T, int> || std::is_same_v<T, long> || std::is_same_v<T, double> ||
+		std::is_same_v<T, bool> || std::is_same_v<T, std::string_view>,
+		"settings must be int, long, double, bool or std::string_view"
+	);
+
+	using type = T;
+
+	std::string_view section;
+	std::string_view key;
+	T defaultValue;
+
+	// Hash of the section and key, as used by `FieldIndex`.
+	std::uint64_t hash;
+
+	constexpr Setting(std::string_view section, std::string_view key, T defaultValue)
+		: section(section), key(key), defaultValue(defaultValue), hash(FieldIndex::hash(section, key)) {}
+};
+
+/**
+ * @brief The types a value can be read as by `INIReader::getMany`.
+ */
+enum class LookupType : std::uint8_t {
+	String,
+	Int,
+	Long,
+	Double,
+	Bool
+};
+
+/**
+ * @brief A value read by `INIReader::getMany`. Only the member that matches
+ * the type of the lookup is used.
+ */
+struct LookupValue {
+	// Value as a string, valid for as long as the reader is.
+	std::string_view string;
+
+	// Value as an `int` or a `long`.
+	long long integer{ 0 };
+
+	// Value as a double-precision floating-point number.
+	double real{ 0.0 };
+
+	// Value as a boolean.
+	bool boolean{ false };
+};
+
+/**
+ * @brief A value to read with `INIReader::getMany`. The type is taken from
+ * the default value:
+ * ```
+ * const Lookup lookups[]{
+ *     { "WINDOW", "Title", "untitled" },
+ *     { "WINDOW", "Width", 800 },
+ *     { "GRAPHICS", "FOV", 90.0 }
+ * };
+ * ```
+ */
+struct Lookup {
+	std::string_view section;
+	std::string_view key;
+	LookupType type;
+
+	// Value to use if the key is missing or cannot be converted.
+	LookupValue defaultValue;
+
+	Lookup(std::string_view section, std::string_view key, std::string_view defValue)
+		: section(section), key(key), type(LookupType::String) {
+		defaultValue.string = defValue;
+	}
+
+	Lookup(std::string_view section, std::string_view key, const char *defValue)
+		: Lookup(section, key, std::string_view(defValue)) {}
+
+	Lookup(std::string_view section, std::string_view key, int defValue)
+		: section(section), key(key), type(LookupType::Int) {
+		defaultValue.integer = defValue;
+	}
+
+	Lookup(std::string_view section, std::string_view key, long defValue)
+		: section(section), key(key), type(LookupType::Long) {
+		defaultValue.integer = defValue;
+	}
+
+	Lookup(std::string_view section, std::string_view key, double defValue)
+		: section(section), key(key), type(LookupType::Double) {
+		defaultValue.real = defValue;
+	}
+
+	Lookup(std::string_view section, std::string_view key, bool defValue)
+		: section(section), key(key), type(LookupType::Bool) {
+		defaultValue.boolean = defValue;
+	}
+};
+
+/**
+ * @brief The outcome of one lookup made by `INIReader::getMany`.
+ */
+struct LookupResult {
+	// The value, or the default of the lookup if it could not be read.
+	LookupValue value;
+
+	// Why the default was used, if it was.
+	ConversionError error{ ConversionError::None };
+};
+
+/**
+ * @brief Read-only contents of a whole file. The file is memory-mapped on
+ * platforms that support it and read into a single buffer otherwise.
+ *
+ * A mapping shows the file as it is on disk, not as it was when it was
+ * mapped: if another process truncates the file, reading past its new end
+ * raises `SIGBUS`, and if it rewrites the file in place the contents change.
+ * Files that are mapped should only be replaced by renaming a new file over
+ * them. Only regular files are mapped.
+ */
+class MappedFile {
+
+private:
 
 	/**
-	 * @brief Gets a double-precision floating-point value from the
-	 * configuration file.
-	 * @param section The name of the section to get the value from.
-	 * @param key The key associated with the value.
-	 * @param defValue The value to return if no such section or key is found.
-	 * @returns The associated value if `key` is found, else `defValue`.
+	 * @brief Start of the file contents.
 	 */
-	const double getDouble(
-		const std::string &section,
-		const std::string &key,
-		const double defValue
-	) const;
+	const char *m_data{ nullptr };
 
 	/**
-	 * @brief Gets a boolean value from the configuration file.
-	 * @param section The name of the section to get the value from.
-	 * @param key The key associated with the value.
-	 * @param defValue The value to return if no such section or key is found.
-	 * @returns The associated value if `key` is found, else `defValue`.
+	 * @brief Size of the file contents in bytes.
 	 */
-	const bool getBool(
-		const std::string &section,
-		const std::string &key,
-		const bool defValue
-	) const;
+	std::size_t m_size{ 0 };
 
 	/**
-	 * @returns A string representation of the error that occurred.
+	 * @brief Whether or not the file could be opened.
 	 */
-	const std::string getError() const {
-		return errorStrings[static_cast<int>(m_error)];
+	bool m_open{ false };
+
+	/**
+	 * @brief Whether `m_data` is a memory mapping (`true`) or a heap buffer.
+	 */
+	bool m_mapped{ false };
+
+public:
+
+	/**
+	 * @brief Maps the contents of a file into memory.
+	 * @param fileName The path of the file to map.
+	 */
+	explicit MappedFile(const char *fileName);
+
+	/**
+	 * @brief Unmaps (or frees) the file contents.
+	 */
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/**
+	 * @returns `true` if the file was opened successfully, `false` otherwise.
+	 */
+	bool isOpen() const {
+		return m_open;
 	}
 
 	/**
-	 * @brief Gets the fields present in the given section.
-	 * @param section The name of the section to get the fields from.
+	 * @returns The contents of the file.
 	 */
-	const std::set<Field> getSectionFields(const std::string &section) const {
-		return m_lookup.at(section);
+	std::string_view data() const {
+		return std::string_view(m_data, m_size);
 	}
 
+};
+
+/**
+ * @brief What happened while loading a file, collected when compiled with
+ * `COLLECT_LOAD_STATS` (and all zero otherwise).
+ */
+struct LoadStats {
+	// Number of bytes of text that were parsed.
+	std::size_t bytes{ 0 };
+
+	// Number of lines, section declarations, key-value pairs and comments.
+	std::size_t lines{ 0 };
+	std::size_t sections{ 0 };
+	std::size_t fields{ 0 };
+	std::size_t comments{ 0 };
+
+	// Time spent reading the file from a stream, or mapping it.
+	std::chrono::nanoseconds reading{ 0 };
+
+	// Time spent finding lines and the parts of each line.
+	std::chrono::nanoseconds lexing{ 0 };
+
+	// Time spent removing whitespace from lines, keys and values.
+	std::chrono::nanoseconds trimming{ 0 };
+
+	// Time spent in the events of the handler, which for `INIReader` is the
+	// sum of `converting` and `inserting`.
+	std::chrono::nanoseconds handling{ 0 };
+
+	// Time spent converting values to every type (`INIReader` only).
+	std::chrono::nanoseconds converting{ 0 };
+
+	// Time spent copying text and storing sections and fields (`INIReader` only).
+	std::chrono::nanoseconds inserting{ 0 };
+
+	// Time spent putting fields in order and indexing them (`INIReader` only).
+	std::chrono::nanoseconds indexing{ 0 };
+
+	// Time spent loading from start to finish.
+	std::chrono::nanoseconds total{ 0 };
+
+	// Number of heap allocations made for the stored text, sections and
+	// fields, and the most bytes they held at once (`INIReader` only).
+	std::size_t allocations{ 0 };
+	std::size_t peakBytes{ 0 };
+
 	/**
-	 * @returns The names of the sections present in the configuration file.
+	 * @brief Adds the counts and times of another part of a load.
 	 */
-	const std::set<std::string> getSectionNames() const {
-		return m_section_names;
+	LoadStats &operator+=(const LoadStats &other) {
+		bytes += other.bytes;
+		lines += other.lines;
+		sections += other.sections;
+		fields += other.fields;
+		comments += other.comments;
+		reading += other.reading;
+		lexing += other.lexing;
+		trimming += other.trimming;
+		handling += other.handling;
+		converting += other.converting;
+		inserting += other.inserting;
+		indexing += other.indexing;
+		total += other.total;
+		return *this;
 	}
+};
+
+#if COLLECT_LOAD_STATS
+/**
+ * @brief Passes allocations on to another memory resource, counting them
+ * and the number of bytes held. It is not thread-safe.
+ */
+class CountingResource : public std::pmr::memory_resource {
+
+private:
+
+	std::pmr::memory_resource *m_upstream;
+	std::size_t m_allocations{ 0 };
+	std::size_t m_bytes{ 0 };
+	std::size_t m_peak_bytes{ 0 };
+
+	void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+		void *memory = m_upstream->allocate(bytes, alignment);
+		++m_allocations;
+		m_bytes += bytes;
+		m_peak_bytes = std::max(m_peak_bytes, m_bytes);
+		return memory;
+	}
+
+	void do_deallocate(void *memory, std::size_t bytes, std::size_t alignment) override {
+		m_upstream->deallocate(memory, bytes, alignment);
+		m_bytes -= bytes;
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+
+public:
+
+	explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+		: m_upstream(upstream) {}
+
+	/**
+	 * @returns The number of allocations made so far.
+	 */
+	std::size_t allocations() const {
+		return m_allocations;
+	}
+
+	/**
+	 * @returns The most bytes that were held at once.
+	 */
+	std::size_t peakBytes() const {
+		return m_peak_bytes;
+	}
+
+};
+#endif
+
+/**
+ * @brief How often a key was read, collected when compiled with
+ * `COUNT_KEY_ACCESSES`.
+ */
+struct KeyAccess {
+	std::string section;
+	std::string key;
+
+	// Number of reads that found a value.
+	std::uint64_t hits{ 0 };
+
+	// Number of reads that found no value and fell back to the default.
+	std::uint64_t misses{ 0 };
+};
+
+#if COUNT_KEY_ACCESSES
+/**
+ * @brief Counts the reads of every (section, key) pair. Each thread counts
+ * in a shard of its own, so threads never write to the same memory and
+ * counting a read takes no lock once the key has been seen by that thread.
+ */
+class AccessCounter {
+
+private:
+
+	/**
+	 * @brief The counts of one key in one shard. Only the thread owning the
+	 * shard writes to them.
+	 */
+	struct Counts {
+		std::string section;
+		std::string key;
+		std::atomic<std::uint64_t> hits{ 0 };
+		std::atomic<std::uint64_t> misses{ 0 };
+	};
+
+	/**
+	 * @brief Passes a hash through unchanged, since keys are already hashed.
+	 */
+	struct Identity {
+		std::size_t operator()(std::uint64_t hash) const {
+			return static_cast<std::size_t>(hash);
+		}
+	};
+
+	/**
+	 * @brief The counts of a single thread.
+	 */
+	struct Shard {
+		// Held while keys are added, and while the counts are collected.
+		std::mutex mutex;
+
+		// Counts of every key read on the thread, by the hash of the section
+		// and key (or the next free value, if two keys have the same hash).
+		std::unordered_map<std::uint64_t, Counts, Identity> keys;
+	};
+
+	/**
+	 * @brief Distinguishes counters, so that a shard remembered by a thread
+	 * is never used with a newer counter at the same address.
+	 */
+	const std::uint64_t m_id;
+
+	/**
+	 * @brief Held while a shard is added, and while the counts are collected.
+	 */
+	mutable std::mutex m_mutex;
+
+	/**
+	 * @brief The shard of every thread that has read a key.
+	 */
+	std::vector<std::pair<std::thread::id, std::unique_ptr<Shard>>> m_shards;
+
+	/**
+	 * @returns The shard of the calling thread, which is created on its
+	 * first read. Only the first read of each thread from each counter takes
+	 * a lock.
+	 */
+	Shard &shard();
+
+	/**
+	 * @returns The shard of the calling thread, which is added if it does
+	 * not exist yet. Takes the lock.
+	 */
+	Shard &addShard();
+
+	/**
+	 * @returns The counts of a key in `shard`, which are added if this is
+	 * the first time the thread reads the key.
+	 */
+	static Counts &counts(Shard &shard, std::string_view section, std::string_view key, std::uint64_t hash);
+
+public:
+
+	AccessCounter();
+
+	/**
+	 * @brief Counts a read of a key.
+	 * @param hash The hash of `section` and `key`.
+	 * @param hit Whether a value was found.
+	 */
+	void record(std::string_view section, std::string_view key, std::uint64_t hash, bool hit);
+
+	/**
+	 * @returns The counts of every key added up over all threads, with the
+	 * most read keys first.
+	 */
+	std::vector<KeyAccess> collect() const;
+
+};
+#endif
+
+/**
+ * @brief Receives the parts of a `.ini` file from an `INIParser` as they are
+ * found. Override the events of interest; by default every event is ignored.
+ *
+ * Views passed to the events are only valid until the event returns, unless
+ * the parser was given text that outlives it.
+ */
+class INIHandler {
+
+public:
+
+	virtual ~INIHandler() = default;
+
+	/**
+	 * @brief Called for every section declaration.
+	 * @param name The name of the section.
+	 * @param line The line number of the declaration.
+	 * @returns `true` to continue parsing, `false` to stop.
+	 */
+	virtual bool onSection(std::string_view /*name*/, int /*line*/) {
+		return true;
+	}
+
+	/**
+	 * @brief Called for every key-value pair.
+	 * @param section The name of the section the pair is in.
+	 * @param key The key, without surrounding whitespace.
+	 * @param value The value, without surrounding whitespace, quotes or comments.
+	 * @param line The line number of the pair.
+	 * @returns `true` to continue parsing, `false` to stop.
+	 */
+	virtual bool onKeyValue(std::string_view /*section*/, std::string_view /*key*/, std::string_view /*value*/, int /*line*/) {
+		return true;
+	}
+
+	/**
+	 * @brief Called for every comment, whether on a line of its own or after
+	 * a value.
+	 * @param comment The text of the comment, after the comment prefix.
+	 * @param line The line number of the comment.
+	 * @returns `true` to continue parsing, `false` to stop.
+	 */
+	virtual bool onComment(std::string_view /*comment*/, int /*line*/) {
+		return true;
+	}
+
+	/**
+	 * @brief Called for every include directive (`!include path`). The
+	 * parser does not read the file itself.
+	 * @param path The path as written, without surrounding whitespace or
+	 * quotes, which may contain wildcards.
+	 * @param line The line number of the directive.
+	 * @returns `true` to continue parsing, `false` to stop.
+	 */
+	virtual bool onInclude(std::string_view /*path*/, int /*line*/) {
+		return true;
+	}
+
+	/**
+	 * @brief Called when the file is malformed. Parsing stops afterwards.
+	 * @param error The error that occurred.
+	 * @param line The line number the error occurred on.
+	 */
+	virtual void onError(ErrorCode /*error*/, int /*line*/) {}
+
+};
+
+/**
+ * @brief Positions of the characters the parser needs in one line, found by
+ * a single scan over the text. Every position is relative to the start of
+ * the line, and is `npos` when the character does not appear.
+ */
+struct LineMarks {
+	static constexpr std::size_t npos = std::string_view::npos;
+
+	// Number of characters in `START_COMMENT_PREFIXES`.
+	static constexpr std::size_t commentPrefixCount = sizeof(START_COMMENT_PREFIXES) - 1;
+
+	// First '=' in the line.
+	std::size_t equals{ npos };
+
+	// First ']' in the line.
+	std::size_t close{ npos };
+
+	// Last '"' in the line.
+	std::size_t lastQuote{ npos };
+
+	// First occurrence of each comment prefix after the first '=', in the
+	// same order as `START_COMMENT_PREFIXES`.
+	std::size_t comments[commentPrefixCount > 0 ? commentPrefixCount : 1];
+
+	LineMarks() {
+		for (auto &comment : comments) {
+			comment = npos;
+		}
+	}
+};
+
+/**
+ * @brief Splits `.ini` text into sections, key-value pairs and comments,
+ * passing each one to an `INIHandler` without storing anything itself, so
+ * that arbitrarily large files can be processed in constant memory.
+ */
+class INIParser {
+
+private:
+
+	/**
+	 * @brief The handler that receives everything that is parsed.
+	 */
+	INIHandler &m_handler;
+
+	/**
+	 * @brief The current line number in the file.
+	 */
+	int m_line_num{ 0 };
+
+	/**
+	 * @brief Keeps track of whether or not the current line is inside a section.
+	 */
+	bool m_in_section{ false };
+
+	/**
+	 * @brief Keeps track of whether or not the current section has no
+	 * key-value pairs yet (used when `m_in_section` is true).
+	 */
+	bool m_section_empty{ false };
+
+	/**
+	 * @brief Set when the handler asks for parsing to stop.
+	 */
+	bool m_stopped{ false };
+
+	/**
+	 * @brief The current section (used when `m_in_section` is true).
+	 */
+	std::string m_curr_section;
+
+	/**
+	 * @brief Keep track of any error that occurs during parsing.
+	 */
+	ErrorCode m_error{ ErrorCode::None };
+
+#if COLLECT_LOAD_STATS
+	/**
+	 * @brief What the parser has found and where its time went.
+	 */
+	LoadStats m_stats;
+#endif
+
+	/**
+	 * @brief Records an error and reports it to the handler.
+	 * @returns `false`, so that parsing stops.
+	 */
+	bool fail(ErrorCode error);
+
+	/**
+	 * @brief Removes a comment from a string.
+	 * @param str The string to remove the comment from, which is left without
+	 * the comment or the whitespace before it.
+	 * @param comment Set to the text of the comment, if one is found.
+	 * @param marks The positions found in the line containing `str`.
+	 * @param offset The position of `str` in the line.
+	 * @returns `true` if a comment was found, `false` otherwise.
+	 */
+	bool removeComment(std::string_view &str, std::string_view &comment, const LineMarks &marks, std::size_t offset) const;
+
+	/**
+	 * @brief Parses a section in a file.
+	 * @param str The string containing the section.
+	 * @param closingIdx The position of the first ']' in `str`.
+	 * @returns `true` if parsing should continue, `false` otherwise.
+	 */
+	bool parseSection(std::string_view str, std::size_t closingIdx);
+
+	/**
+	 * @brief Parses a key-value pair inside a section in a file.
+	 * @param str The line containing the pair.
+	 * @param marks The positions found in the line.
+	 * @returns `true` if parsing should continue, `false` otherwise.
+	 */
+	bool parsePair(std::string_view str, const LineMarks &marks);
+
+#if ALLOW_INCLUDES
+	/**
+	 * @brief Parses an include directive, if the line is one.
+	 * @param str The line, without trailing whitespace.
+	 * @param handled Set to `true` if the line is an include directive.
+	 * @returns `true` if parsing should continue, `false` otherwise.
+	 */
+	bool parseInclude(std::string_view str, bool &handled);
+#endif
+
+	/**
+	 * @brief Parses the next line of a file once it has been scanned.
+	 * @param str The line, without its line terminator or trailing whitespace.
+	 * @param marks The positions found in the line.
+	 * @returns `true` if parsing should continue, `false` otherwise.
+	 */
+	bool parseLine(std::string_view str, const LineMarks &marks);
+
+	/**
+	 * @brief Scans text 64 bytes at a time, classifying every character in
+	 * one pass, and parses each complete line it contains.
+	 * @param data The text to scan.
+	 * @param consumed Set to the length of the complete lines that were
+	 * parsed, so that the rest can be carried over.
+	 * @returns `true` if parsing should continue, `false` otherwise.
+	 */
+	bool scanLines(std::string_view data, std::size_t &consumed);
+
+public:
+
+	/**
+	 * @brief Creates a parser that passes everything it finds to `handler`.
+	 */
+	explicit INIParser(INIHandler &handler) : m_handler(handler) {}
+
+	/**
+	 * @brief Parses the next line of a file.
+	 * @param str The line, without its line terminator.
+	 * @returns `true` if parsing should continue, `false` otherwise.
+	 */
+	bool parseLine(std::string_view str);
+
+	/**
+	 * @brief Ends the input after the last call to `parseLine`, reporting
+	 * the last section if it has no key-value pairs. `parse`, `parseStream`
+	 * and `parseFile` call this themselves.
+	 * @returns The error that occurred, if any.
+	 */
+	ErrorCode finish();
+
+	/**
+	 * @brief Parses a whole file that is in memory.
+	 * @param data The contents of the file.
+	 * @returns The error that occurred, if any.
+	 */
+	ErrorCode parse(std::string_view data);
+
+	/**
+	 * @brief Parses a stream in fixed-size blocks, so memory use only
+	 * depends on the length of the longest line.
+	 * @param in The stream to read from.
+	 * @returns The error that occurred, if any.
+	 */
+	ErrorCode parseStream(std::istream &in);
+
+	/**
+	 * @brief Parses a file in fixed-size blocks, so memory use only depends
+	 * on the length of the longest line.
+	 * @param fileName The path of the file to read from.
+	 * @returns The error that occurred, if any.
+	 */
+	ErrorCode parseFile(const char *fileName);
+
+	/**
+	 * @returns The number of the line that was parsed last.
+	 */
+	int getLineNumber() const {
+		return m_line_num;
+	}
+
+	/**
+	 * @returns The error that occurred, if any.
+	 */
+	ErrorCode getError() const {
+		return m_error;
+	}
+
+	/**
+	 * @returns What the parser has found so far and where its time went,
+	 * which is only collected when compiled with `COLLECT_LOAD_STATS`.
+	 */
+	LoadStats getStats() const;
+
+};
+
+/**
+ * @brief Class that reads a `.ini` file and stores the name-value pairs
+ * for easy access.
+ */
+class INIReader {
+
+private:
+
+	/**
+	 * @brief Keep track of any error that occurs during parsing.
+	 */
+	ErrorCode m_error{ ErrorCode::None };
+
+#if USE_PMR_STORAGE
+	template <typename T>
+	using Vector = std::pmr::vector<T>;
+	using SectionMap = std::pmr::map<std::string_view, FieldSet, std::less<>>;
+	using SectionNames = std::pmr::set<std::string_view, std::less<>>;
+#else
+	template <typename T>
+	using Vector = std::vector<T>;
+	using SectionMap = std::map<std::string_view, FieldSet, std::less<>>;
+	using SectionNames = std::set<std::string_view, std::less<>>;
+#endif
+
+#if USE_FLAT_STORAGE
+	/**
+	 * @brief A section and the range of fields that belong to it.
+	 */
+	struct Section {
+		std::string_view name;
+		std::size_t first;
+		std::size_t last;
+	};
+#endif
+
+	/**
+	 * @brief Everything parsed from the file. It is never modified once the
+	 * constructor returns, so copies of a reader share it.
+	 */
+	struct Contents {
+#if COLLECT_LOAD_STATS
+		// Counts the allocations made for everything below. Declared first
+		// so that it outlives them.
+		CountingResource counter;
+
+		// What happened while loading.
+		LoadStats stats;
+#endif
+
+#if USE_ARENA_STORAGE
+		// Arena holding all copied text and container nodes. Declared first
+		// so that it is released after everything allocated from it.
+		std::pmr::monotonic_buffer_resource arena;
+#endif
+
+		// Mapped file that sections and fields point into (only used when
+		// loading with `LoadMode::Mapped`).
+		std::shared_ptr<const MappedFile> mapping;
+
+		// Text that sections and fields point into (only used when parsing
+		// a string passed to `fromString`, or a copy of a file that
+		// `fromCache` could not load from its cache).
+		std::string buffer;
+
+		// Whether the text being parsed lives as long as the contents do, in
+		// which case sections and fields point straight into it.
+		bool inPlace{ false };
+
+		// Whether everything was restored from a cache file (held by
+		// `mapping`) instead of being parsed.
+		bool cached{ false };
+
+		// Include directives found while parsing, in order, until the files
+		// they name are loaded.
+		std::vector<std::string> includes;
+
+		// Whether the text had include directives, so that it depends on
+		// files that a cache stamp does not describe.
+		bool hasIncludes{ false };
+
+		// Directories named by include directives, including those where a
+		// wildcard matched nothing, in the order they were found.
+		std::vector<std::string> includeDirectories;
+
+		// Files that were included, which sections and fields from them
+		// point into (only used when the file itself is mapped; otherwise
+		// their text is copied).
+		std::vector<std::shared_ptr<const MappedFile>> included;
+
+		// Contents of the readers that sections and fields point into, from
+		// the lowest precedence to the highest (only used by readers made
+		// with `fromLayers`).
+		std::vector<std::shared_ptr<const Contents>> layers;
+
+		// Copies of the text that sections and fields point into, when the
+		// file is not mapped and the arena is not used. A deque is used so
+		// that existing strings never move when new ones are added.
+#if COLLECT_LOAD_STATS
+		std::pmr::deque<std::pmr::string> strings;
+#else
+		std::deque<std::string> strings;
+#endif
+
+#if USE_FLAT_STORAGE
+		// Fields of every section, ordered by section and then by key.
+		Vector<Field> fields;
+
+		// Sections ordered by name, each owning a contiguous range of `fields`.
+		Vector<Section> sections;
+
+		// Names of all sections present in the given `.ini` file, in order.
+		Vector<std::string_view> sectionNames;
+
+		// Fields in the order they were parsed, along with their section,
+		// until `finish` sorts them into `fields`.
+		std::vector<std::pair<std::string_view, Field>> pending;
+#else
+		// Lookup table containing key-values pairs, where the key is the name
+		// of the section and the values are the fields present in that section.
+		SectionMap lookup;
+
+		// Names of all sections present in the given `.ini` file.
+		SectionNames sectionNames;
+#endif
+
+		// Index over every field, used to find values.
+		FieldIndex index;
+
+#if COUNT_CACHED_CONVERSIONS
+		// Number of typed reads that were served from the converted value
+		// stored in a field.
+		std::atomic<std::size_t> cachedConversions{ 0 };
+#endif
+
+#if COUNT_KEY_ACCESSES
+		// Number of times each key was read, and whether it was found.
+		AccessCounter accesses;
+#endif
+
+		/**
+		 * @param sizeHint Size of the file being parsed, used to size the
+		 * first block of the arena.
+		 */
+		explicit Contents(std::size_t sizeHint);
+
+#if USE_PMR_STORAGE
+		/**
+		 * @returns Where containers and copied text are allocated from.
+		 */
+		std::pmr::memory_resource *storage() {
+#	if USE_ARENA_STORAGE
+			return &arena;
+#	else
+			return &counter;
+#	endif
+		}
+#endif
+
+		/**
+		 * @brief Copies text into storage owned by the contents.
+		 * @returns A view of the copy, which stays valid for the lifetime of
+		 * the contents.
+		 */
+		std::string_view store(std::string_view str);
+
+		/**
+		 * @brief Records the name of a section.
+		 */
+		void addSection(std::string_view name);
+
+		/**
+		 * @brief Adds a field to a section, unless the section already has a
+		 * field with the same key.
+		 */
+		void addField(std::string_view section, const Field &field);
+
+		/**
+		 * @brief Puts everything in its final order and indexes every field.
+		 * Called once parsing has finished.
+		 */
+		void finish();
+
+#if COLLECT_LOAD_STATS
+		/**
+		 * @brief Adds what a parser found and where its time went.
+		 */
+		void addParseStats(const LoadStats &parsed);
+
+		/**
+		 * @brief Records the time taken by a load that started at `start`,
+		 * and the allocations it made.
+		 */
+		void finishStats(std::chrono::steady_clock::time_point start);
+#endif
+
+		/**
+		 * @brief Makes room for everything restored from a cache.
+		 */
+		void reserve(std::size_t sections, std::size_t fields);
+
+		/**
+		 * @brief Adds a section that comes after every section added so far,
+		 * so that nothing has to be sorted (used when restoring a cache).
+		 */
+		void appendSection(std::string_view name);
+
+		/**
+		 * @brief Adds a field that comes after every field added so far, so
+		 * that nothing has to be sorted (used when restoring a cache).
+		 * @returns The stored field, which does not move again.
+		 */
+		const Field *appendField(std::string_view section, const Field &field);
+	};
+
+	/**
+	 * @brief The parsed contents of the file.
+	 */
+	std::shared_ptr<Contents> m_contents;
+
+	/**
+	 * @brief Handler that stores everything the parser finds in `Contents`.
+	 */
+	class Builder;
+
+	/**
+	 * @brief The sections and fields parsed from part of a file, which are
+	 * merged into `Contents` once every part has been parsed.
+	 */
+	struct Chunk;
+
+	/**
+	 * @brief Handler that stores everything the parser finds in a `Chunk`.
+	 */
+	class ChunkBuilder;
+
+	/**
+	 * @brief A file named by an include directive, along with everything
+	 * parsed from it.
+	 */
+	struct IncludedFile;
+
+	/**
+	 * @brief Adds the sections and fields of a chunk to the contents, in
+	 * the order they were parsed.
+	 * @param chunk The chunk to add.
+	 * @param copy Whether to copy the text of the chunk into the contents
+	 * instead of pointing into it.
+	 */
+	void mergeChunk(const Chunk &chunk, bool copy);
+
+	/**
+	 * @brief Adds the sections and fields of an included file to the
+	 * contents, followed by those of the files it includes.
+	 * @param files Every file that was loaded, where the first is the file
+	 * that was parsed (whose contents were already added).
+	 * @param file The position of the file to add in `files`.
+	 * @param state Whether each file has been added, or is being added.
+	 * @param copy Whether to copy the text of the files into the contents.
+	 * @returns The first error in the file or the files it includes.
+	 */
+	ErrorCode mergeIncluded(const std::deque<IncludedFile> &files, std::size_t file, std::vector<std::uint8_t> &state, bool copy);
+
+	/**
+	 * @brief Loads the files named by the include directives found while
+	 * parsing, and the files those include in turn, parsing them on a pool
+	 * of threads. Their sections and fields are added after the ones that
+	 * were already parsed: every file is followed by the files it includes,
+	 * in the order of its directives, so a file's own values take
+	 * precedence over the values it includes.
+	 * @param fileName The path of the file that was parsed, which relative
+	 * paths are resolved against, or `nullptr` for text that is not in a
+	 * file.
+	 * @param directory The directory that relative paths are resolved
+	 * against when `fileName` is `nullptr`. If both are `nullptr`, include
+	 * directives are refused with `ErrorCode::IncludeNotAllowed`.
+	 * @param threads The most threads to use, where `0` uses one thread per
+	 * core. Threads are only started while more files are waiting than
+	 * there are threads to load them.
+	 */
+	void readIncludes(const char *fileName, const char *directory, unsigned threads);
+
+	/**
+	 * @brief Identifies the exact contents of a source file that a cache was
+	 * built from.
+	 */
+	struct CacheStamp;
+
+	/**
+	 * @brief Restores the contents from a cache file, if it was built from a
+	 * source file matching `stamp` by this version of the library.
+	 * @param cacheName The path of the cache file.
+	 * @param stamp The source file as it is now.
+	 * @returns `true` if the cache was used, `false` if it is missing, out of
+	 * date or damaged.
+	 */
+	bool readCache(const char *cacheName, const CacheStamp &stamp);
+
+	/**
+	 * @brief Writes the contents to a cache file describing the source file
+	 * `stamp`, replacing the cache atomically.
+	 * @returns `true` if the cache was written, `false` otherwise.
+	 */
+	bool writeCache(const char *cacheName, const CacheStamp &stamp) const;
+
+	/**
+	 * @brief Converts a value to each of the supported types.
+	 * @param str The value to convert.
+	 * @returns The value as each type, or why it could not be converted.
+	 */
+	static TypedValue convertAll(std::string_view str);
+
+	/**
+	 * @brief Finds the converted form of a value.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @returns The converted value, or `nullptr` if no non-empty value exists.
+	 */
+	const TypedValue *getTyped(std::string_view section, std::string_view key) const;
+
+	/**
+	 * @brief Gets the converted form of a field's value. Every typed read
+	 * goes through here, whichever API it was made with.
+	 * @param field The field, or `nullptr` if no non-empty value exists.
+	 * @returns The converted value, or `nullptr` if `field` is `nullptr`.
+	 */
+	const TypedValue *getTyped(const Field *field) const;
+
+	/**
+	 * @brief Finds a field using a hash that was already computed.
+	 * @param section The name of the section to get the field from.
+	 * @param key The key of the field.
+	 * @param hash The hash of `section` and `key`.
+	 * @returns The field, or `nullptr` if no non-empty value exists.
+	 */
+	const Field *getField(std::string_view section, std::string_view key, std::uint64_t hash) const;
+
+	/**
+	 * @brief Parses a file line by line using `std::ifstream`.
+	 * @param fileName The path of the file to read from.
+	 */
+	void readStream(const char *fileName);
+
+	/**
+	 * @brief Parses a file in place after mapping it into memory.
+	 * @param fileName The path of the file to read from.
+	 */
+	void readMapped(const char *fileName);
+
+	/**
+	 * @brief Parses text that lives as long as the contents do, without
+	 * copying any of it.
+	 * @param data The text to parse.
+	 */
+	void readInPlace(std::string_view data);
+
+	/**
+	 * @brief Parses a file in place on several threads after mapping it into
+	 * memory.
+	 * @param fileName The path of the file to read from.
+	 * @param threads The number of threads to use.
+	 */
+	void readParallel(const char *fileName, unsigned threads);
+
+	/**
+	 * @brief Creates a parser that has not read anything yet (used by the
+	 * factory functions).
+	 */
+	INIReader() = default;
+
+
+public:
+
+	/**
+	 * @brief View over the fields of a section, ordered by key.
+	 */
+#if USE_FLAT_STORAGE
+	using FieldRange = Range<const Field *>;
+#else
+	using FieldRange = Range<FieldSet::const_iterator>;
+#endif
+
+	/**
+	 * @brief View over the names of all sections, in order.
+	 */
+	using SectionNameRange = Range<decltype(Contents::sectionNames)::const_iterator>;
+
+	/**
+	 * @brief Initializes the parser to read from a file. Files included with
+	 * `!include path` are read as well, relative to the file including them.
+	 * They are copied into the reader unless `mode` maps the file, in which
+	 * case they stay mapped as well.
+	 * @param fileName The path of the file to read from.
+	 * @param mode How the file should be loaded.
+	 * @param threads The number of threads to use with `LoadMode::Parallel`
+	 * and to read included files, where `0` uses one thread per core.
+	 */
+	INIReader(const char *fileName, LoadMode mode = LoadMode::Stream, unsigned threads = 0);
+
+	/**
+	 * @brief Parses the contents of a `.ini` file that is already in memory,
+	 * with the same rules as reading it from a file. The reader takes
+	 * ownership of the text, so moving a string in avoids copying it.
+	 * @param contents The text to parse.
+	 * @param includeDirectory The directory that relative paths in include
+	 * directives are resolved against. By default include directives are
+	 * refused (with `ErrorCode::IncludeNotAllowed`), so that text received
+	 * from elsewhere cannot read local files. Absolute paths and `..` are
+	 * not confined to the directory, so only pass one for trusted text.
+	 * @returns The parser, which should be checked with `success()`.
+	 */
+	static INIReader fromString(std::string contents, const char *includeDirectory = nullptr);
+
+	/**
+	 * @brief Parses the contents of a `.ini` file that is already in memory,
+	 * without copying any of it. The caller must keep the text alive for as
+	 * long as the reader and its copies are, e.g. a configuration embedded
+	 * in the binary.
+	 * @param contents The text to parse.
+	 * @param includeDirectory The directory that relative paths in include
+	 * directives are resolved against, or `nullptr` to refuse include
+	 * directives (see `fromString`).
+	 * @returns The parser, which should be checked with `success()`.
+	 */
+	static INIReader fromView(std::string_view contents, const char *includeDirectory = nullptr);
+
+	/**
+	 * @brief Loads a file from a binary cache of its parsed contents, which
+	 * is mapped into memory and used in place without parsing anything or
+	 * converting any values. The cache is only used if the size,
+	 * modification time and contents of the file match the ones it was
+	 * built from; otherwise a copy of the file is parsed, so that the reader
+	 * does not depend on a file that may be edited in place, and the cache
+	 * is rewritten for next time, if the file has no errors. Only the cache,
+	 * which is always replaced atomically, stays mapped.
+	 * @param fileName The path of the `.ini` file.
+	 * @param cacheName The path of the cache file, which need not exist.
+	 * @returns The parser, which should be checked with `success()`.
+	 */
+	static INIReader fromCache(const char *fileName, const char *cacheName);
+
+	/**
+	 * @brief Writes the parsed contents to a binary cache that `fromCache`
+	 * can load. The reader must have been loaded from `fileName` as it is
+	 * now, and must have no errors.
+	 * @param fileName The path of the `.ini` file the reader was loaded from.
+	 * @param cacheName The path of the cache file, which is replaced
+	 * atomically so that other processes never see part of it.
+	 * @returns `true` if the cache was written, `false` otherwise.
+	 */
+	bool saveCache(const char *fileName, const char *cacheName) const;
+
+	/**
+	 * @returns `true` if the contents were restored from a cache instead of
+	 * being parsed, `false` otherwise.
+	 */
+	bool loadedFromCache() const {
+		return m_contents->cached;
+	}
+
+	/**
+	 * @brief Combines several readers into one, where a value in a later
+	 * layer overrides the same key in an earlier one, e.g. shipped defaults
+	 * followed by site and host files. Every field of every layer is indexed
+	 * once here, so each read is a single lookup however many layers there
+	 * are. No text is copied: the layers are kept alive by the result, and
+	 * its sections and fields point into them. Empty values count as
+	 * missing, so they never hide a value in an earlier layer.
+	 * @param layers The readers to combine, from the lowest precedence to
+	 * the highest. A reader that failed to load may be left out, since its
+	 * error is passed on to the result.
+	 * @returns The combined reader, whose error is the first error of any
+	 * layer.
+	 */
+	static INIReader fromLayers(const std::vector<INIReader> &layers);
+
+	/**
+	 * @brief Finds the layer that a value was read from.
+	 * @param section The name of the section the value is in.
+	 * @param key The key associated with the value.
+	 * @returns The position of the layer in the readers given to
+	 * `fromLayers` (or `0` for a reader that was not made from layers), or
+	 * `-1` if no non-empty value exists.
+	 */
+	int getLayer(std::string_view section, std::string_view key) const;
+
+	/**
+	 * @brief Destructor for the parser.
+	 */
+	~INIReader() = default;
+
+	/**
+	 * @brief Removes any leading ASCII whitespace (spaces, tabs, carriage
+	 * returns, newlines, form feeds and vertical tabs).
+	 * @param str The string to remove leading whitespace from.
+	 * @returns A view of `str` without the leading whitespace.
+	 */
+	static std::string_view lstrip(std::string_view str);
+
+	/**
+	 * @brief Removes any trailing ASCII whitespace.
+	 * @param str The string to remove trailing whitespace from.
+	 * @returns A view of `str` without the trailing whitespace.
+	 */
+	static std::string_view rstrip(std::string_view str);
+
+	/**
+	 * @brief Removes both leading and trailing ASCII whitespace.
+	 * @param str The string to remove leading and trailing whitespace from.
+	 * @returns A view of `str` without the surrounding whitespace.
+	 */
+	static std::string_view trim(std::string_view str);
+
+	/**
+	 * @brief Check if initialization of INIReader was successful.
+	 * @returns `true` if no error occurred parsing the file, `false` otherwise.
+	 */
+	const bool success() const;
+
+	/**
+	 * @brief Converts a string to the type `T`, which may be `int`, `long`,
+	 * `long long`, `double` or `bool`. Numbers are parsed with `std::from_chars`, so the
+	 * conversion does not depend on the locale and never throws. Booleans
+	 * accept `true`, `yes`, `on`, `1`, `false`, `no`, `off` and `0`, ignoring
+	 * case.
+	 * @param str The string to convert (without surrounding whitespace).
+	 * @returns The converted value, or the reason the conversion failed.
+	 */
+	template <typename T>
+	static Conversion<T> convert(std::string_view str);
+
+	/**
+	 * @brief Gets a string value from the configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @param defValue The value to return if no such section or key is found.
+	 * @returns The associated value if `key` is found, else `defValue`.
+	 */
+	const std::string getString(
+		std::string_view section,
+		std::string_view key,
+		std::string_view defValue
+	) const;
+
+	/**
+	 * @brief Gets a string value from the configuration file without copying it.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @param defValue The value to return if no such section or key is found.
+	 * @returns A view of the associated value if `key` is found, else
+	 * `defValue`. The view is valid for as long as the reader is.
+	 */
+	std::string_view getStringView(
+		std::string_view section,
+		std::string_view key,
+		std::string_view defValue
+	) const;
+
+	/**
+	 * @brief Gets an integer value from the configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @param defValue The value to return if no such section or key is found.
+	 * @returns The associated value if `key` is found and can be converted,
+	 * else `defValue`.
+	 */
+	const int getInt(
+		std::string_view section,
+		std::string_view key,
+		const int defValue
+	) const;
+
+	/**
+	 * @brief Gets a long value from the configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @param defValue The value to return if no such section or key is found.
+	 * @returns The associated value if `key` is found and can be converted,
+	 * else `defValue`.
+	 */
+	const long getLong(
+		std::string_view section,
+		std::string_view key,
+		const long defValue
+	) const;
+
+	/**
+	 * @brief Gets a double-precision floating-point value from the
+	 * configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @param defValue The value to return if no such section or key is found.
+	 * @returns The associated value if `key` is found and can be converted,
+	 * else `defValue`.
+	 */
+	const double getDouble(
+		std::string_view section,
+		std::string_view key,
+		const double defValue
+	) const;
+
+	/**
+	 * @brief Gets a boolean value from the configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @param defValue The value to return if no such section or key is found.
+	 * @returns The associated value if `key` is found and can be converted,
+	 * else `defValue`.
+	 */
+	const bool getBool(
+		std::string_view section,
+		std::string_view key,
+		const bool defValue
+	) const;
+
+	/**
+	 * @brief Gets an integer value from the configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @returns The associated value, or why it could not be converted.
+	 */
+	Conversion<int> tryGetInt(std::string_view section, std::string_view key) const;
+
+	/**
+	 * @brief Gets a long value from the configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @returns The associated value, or why it could not be converted.
+	 */
+	Conversion<long> tryGetLong(std::string_view section, std::string_view key) const;
+
+	/**
+	 * @brief Gets a double-precision floating-point value from the
+	 * configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @returns The associated value, or why it could not be converted.
+	 */
+	Conversion<double> tryGetDouble(std::string_view section, std::string_view key) const;
+
+	/**
+	 * @brief Gets a boolean value from the configuration file.
+	 * @param section The name of the section to get the value from.
+	 * @param key The key associated with the value.
+	 * @returns The associated value, or why it could not be converted.
+	 */
+	Conversion<bool> tryGetBool(std::string_view section, std::string_view key) const;
+
+	/**
+	 * @brief Gets the value of a setting, using the hash computed when the
+	 * setting was declared.
+	 * @param setting The setting to get.
+	 * @returns The associated value, or why it could not be converted.
+	 */
+	template <typename T>
+	Conversion<T> tryGet(const Setting<T> &setting) const;
+
+	/**
+	 * @brief Gets the value of a setting, using the hash computed when the
+	 * setting was declared.
+	 * @param setting The setting to get.
+	 * @returns The associated value, or the setting's default if it is missing
+	 * or cannot be converted.
+	 */
+	template <typename T>
+	T get(const Setting<T> &setting) const {
+		return tryGet(setting).valueOr(setting.defaultValue);
+	}
+
+	/**
+	 * @brief Reads many values in one call, which is faster than calling
+	 * the getters one at a time: the index probes of up to 16 lookups are
+	 * started together so that they wait on memory at the same time, and
+	 * consecutive lookups in the same section share the hash of its name.
+	 * @param lookups The values to read.
+	 * @param count The number of lookups.
+	 * @param results Where to write the result of each lookup, in the same
+	 * order, which must have room for `count` results.
+	 */
+	void getMany(const Lookup *lookups, std::size_t count, LookupResult *results) const;
+
+	/**
+	 * @brief Reads many values in one call (see above).
+	 */
+	template <std::size_t N>
+	void getMany(const Lookup (&lookups)[N], LookupResult (&results)[N]) const {
+		getMany(lookups, N, results);
+	}
+
+	/**
+	 * @returns The number of typed reads of existing values, through the
+	 * getters, settings or `getMany`, which were answered from the value
+	 * converted at load time instead of converting the text again. Values
+	 * are always converted at load time, so this counts the conversions
+	 * saved. Only counted when compiled with `COUNT_CACHED_CONVERSIONS`.
+	 */
+	std::size_t getCachedConversions() const {
+#if COUNT_CACHED_CONVERSIONS
+		return m_contents->cachedConversions.load(std::memory_order_relaxed);
+#else
+		return 0;
+#endif
+	}
+
+	/**
+	 * @brief Gets how often every key was read through this reader and its
+	 * copies, including reads of keys that are not in the file. Reads are
+	 * only counted when compiled with `COUNT_KEY_ACCESSES`.
+	 * @returns Every key that was read, with the most read keys first.
+	 */
+	std::vector<KeyAccess> getKeyAccesses() const;
+
+	/**
+	 * @returns The directories that include directives looked for files in,
+	 * including those where a wildcard matched nothing, so that files added
+	 * to them later can be noticed (as `INIWatcher` does).
+	 */
+	const std::vector<std::string> &getIncludeDirectories() const {
+		return m_contents->includeDirectories;
+	}
+
+	/**
+	 * @returns A string representation of the error that occurred.
+	 */
+	const std::string getError() const {
+		return errorStrings[static_cast<int>(m_error)];
+	}
+
+	/**
+	 * @returns What happened while loading the file, which is only
+	 * collected when compiled with `COLLECT_LOAD_STATS`.
+	 */
+	const LoadStats &getLoadStats() const;
+
+	/**
+	 * @brief Gets the fields present in the given section, without copying
+	 * them. The view is valid for as long as the reader is.
+	 * @param section The name of the section to get the fields from.
+	 * @throws std::out_of_range If the section has no fields.
+	 */
+	FieldRange getSectionFields(std::string_view section) const;
+
+	/**
+	 * @brief Gets the fields present in the given section, without copying
+	 * them. The view is valid for as long as the reader is.
+	 * @param section The name of the section to get the fields from.
+	 * @returns The fields of the section, or an empty range if the section
+	 * has no fields.
+	 */
+	FieldRange tryGetSectionFields(std::string_view section) const noexcept;
+
+	/**
+	 * @returns A view of the names of the sections present in the
+	 * configuration file, valid for as long as the reader is.
+	 */
+	SectionNameRange getSectionNames() const {
+		return SectionNameRange(m_contents->sectionNames.begin(), m_contents->sectionNames.end());
+	}
+
+};
+
+template <> Conversion<int> INIReader::convert<int>(std::string_view str);
+template <> Conversion<long long> INIReader::convert<long long>(std::string_view str);
+template <> Conversion<long> INIReader::convert<long>(std::string_view str);
+template <> Conversion<double> INIReader::convert<double>(std::string_view str);
+template <> Conversion<bool> INIReader::convert<bool>(std::string_view str);
+
+template <> Conversion<int> INIReader::tryGet<int>(const Setting<int> &setting) const;
+template <> Conversion<long> INIReader::tryGet<long>(const Setting<long> &setting) const;
+template <> Conversion<double> INIReader::tryGet<double>(const Setting<double> &setting) const;
+template <> Conversion<bool> INIReader::tryGet<bool>(const Setting<bool> &setting) const;
+template <> Conversion<std::string_view> INIReader::tryGet<std::string_view>(const Setting<std::string_view> &setting) const;
+
+/**
+ * @brief The values of a fixed set of settings, looked up once when the
+ * table is created. Reading a setting afterwards is a member access chosen
+ * at compile time, with no hashing or string comparison:
+ * ```
+ * constexpr Setting<int> WindowWidth{ "WINDOW", "Width", 800 };
+ * constexpr Setting<bool> VSync{ "GRAPHICS", "VSYNC", false };
+ *
+ * const SettingTable<WindowWidth, VSync> settings(reader);
+ * int width = settings.get<WindowWidth>();
+ * ```
+ * Asking for a setting that is not in the table does not compile.
+ * @tparam Settings The settings in the table, which must be declared with
+ * static storage duration (e.g. `constexpr` at namespace scope).
+ */
+template <const auto &... Settings>
+class SettingTable {
+
+	static_assert(sizeof...(Settings) > 0, "a setting table needs at least one setting");
+
+private:
+
+	/**
+	 * @brief Keeps the text of `std::string_view` values alive.
+	 */
+	INIReader m_reader;
+
+	/**
+	 * @brief The value of every setting, in the same order as `Settings`.
+	 */
+	std::tuple<typename std::decay_t<decltype(Settings)>::type...> m_values;
+
+	/**
+	 * @brief Why each setting fell back to its default, if it did.
+	 */
+	std::array<ConversionError, sizeof...(Settings)> m_errors{};
+
+	/**
+	 * @returns The position of `S` in `Settings`, or the number of settings
+	 * if it is not in the table.
+	 */
+	template <const auto &S>
+	static constexpr std::size_t indexOf() {
+		constexpr const void *addresses[]{ &Settings... };
+
+		for (std::size_t i = 0; i < sizeof...(Settings); ++i) {
+			if (addresses[i] == &S) {
+				return i;
+			}
+		}
+
+		return sizeof...(Settings);
+	}
+
+	/**
+	 * @brief Looks up the setting at position `I`.
+	 */
+	template <std::size_t I, typename T>
+	void resolve(const Setting<T> &setting) {
+		const Conversion<T> value = m_reader.tryGet(setting);
+		std::get<I>(m_values) = value.valueOr(setting.defaultValue);
+		m_errors[I] = value.error;
+	}
+
+	template <std::size_t... I>
+	void resolveAll(std::index_sequence<I...>) {
+		(resolve<I>(Settings), ...);
+	}
+
+public:
+
+	/**
+	 * @brief Looks up every setting in `reader`.
+	 */
+	explicit SettingTable(const INIReader &reader) : m_reader(reader) {
+		resolveAll(std::index_sequence_for<decltype(Settings)...>());
+	}
+
+	/**
+	 * @returns The value of setting `S`, or its default if it was missing or
+	 * could not be converted.
+	 */
+	template <const auto &S>
+	const auto &get() const {
+		constexpr std::size_t index = indexOf<S>();
+		static_assert(index < sizeof...(Settings), "the setting is not in this table");
+		return std::get<index>(m_values);
+	}
+
+	/**
+	 * @returns Why setting `S` fell back to its default, or
+	 * `ConversionError::None` if it was read from the file.
+	 */
+	template <const auto &S>
+	ConversionError getError() const {
+		constexpr std::size_t index = indexOf<S>();
+		static_assert(index < sizeof...(Settings), "the setting is not in this table");
+		return m_errors[index];
+	}
+
+};
+
+/**
+ * @brief Writes sections and fields as `.ini` text that `INIReader` reads
+ * back exactly, through a buffer so that large files are written in a few
+ * big writes. Values are quoted when they would otherwise be changed by the
+ * parser (e.g. because they contain a comment prefix).
+ *
+ * Text the parser could not read back, such as a value containing a
+ * newline, is not written, and the call that was given it returns `false`.
+ */
+class INIWriter {
+
+private:
+
+	/**
+	 * @brief Where the text goes.
+	 */
+	enum class Sink {
+		String,
+		Stream,
+		Descriptor
+	};
+
+	/**
+	 * @brief The kind of sink being written to.
+	 */
+	Sink m_sink;
+
+	/**
+	 * @brief The string being appended to (used with `Sink::String`).
+	 */
+	std::string *m_string{ nullptr };
+
+	/**
+	 * @brief The stream being written to (used with `Sink::Stream`).
+	 */
+	std::ostream *m_stream{ nullptr };
+
+	/**
+	 * @brief The file being written to (used with `Sink::Descriptor`).
+	 */
+	int m_fd{ -1 };
+
+	/**
+	 * @brief The stream owned by the writer, when a file is written on a
+	 * platform without file descriptors.
+	 */
+	std::unique_ptr<std::ostream> m_owned_stream;
+
+	/**
+	 * @brief The file that is replaced by `commit` (empty unless the writer
+	 * was created with a file name).
+	 */
+	std::string m_file_name;
+
+	/**
+	 * @brief The temporary file written to until `commit` is called.
+	 */
+	std::string m_temp_name;
+
+	/**
+	 * @brief Text that has not been passed to the sink yet.
+	 */
+	std::unique_ptr<char[]> m_buffer;
+
+	/**
+	 * @brief Number of bytes used in `m_buffer`.
+	 */
+	std::size_t m_used{ 0 };
+
+	/**
+	 * @brief Whether any section has been written yet.
+	 */
+	bool m_has_section{ false };
+
+	/**
+	 * @brief Set once writing to the sink fails.
+	 */
+	bool m_failed{ false };
+
+	/**
+	 * @brief Size of `m_buffer` in bytes.
+	 */
+	static constexpr std::size_t BUFFER_SIZE = 1 << 18;
+
+	/**
+	 * @brief Makes room for `length` bytes at the end of the text, passing
+	 * the buffer to the sink first if it is too full.
+	 * @returns Where to put the bytes, or `nullptr` if they would not fit in
+	 * the buffer even when it is empty.
+	 */
+	char *space(std::size_t length);
+
+	/**
+	 * @brief Adds a line made of up to four parts to the text, copying each
+	 * part once.
+	 */
+	void writeLine(std::string_view a, std::string_view b, std::string_view c, std::string_view d = {});
+
+	/**
+	 * @brief Passes text straight to the sink.
+	 */
+	void emit(const char *data, std::size_t length);
+
+public:
+
+	/**
+	 * @brief Creates a writer that appends to a string.
+	 */
+	explicit INIWriter(std::string &out);
+
+	/**
+	 * @brief Creates a writer that writes to a stream, which must outlive it.
+	 */
+	explicit INIWriter(std::ostream &out);
+
+	/**
+	 * @brief Creates a writer that writes to an open file descriptor, which
+	 * is not closed by the writer.
+	 */
+	explicit INIWriter(int fd);
+
+	/**
+	 * @brief Creates a writer that replaces a file. The text goes to a
+	 * temporary file next to it, which is renamed over the file by
+	 * `commit`, so readers only ever see the old or the new file. Nothing is
+	 * replaced if the writer is destroyed without committing.
+	 * @param fileName The path of the file to replace.
+	 */
+	explicit INIWriter(const char *fileName);
+
+	/**
+	 * @brief Flushes any buffered text, and removes the temporary file if a
+	 * file was not committed.
+	 */
+	~INIWriter();
+
+	INIWriter(const INIWriter &) = delete;
+	INIWriter &operator=(const INIWriter &) = delete;
+
+	/**
+	 * @brief Writes a section declaration. Every section needs at least one
+	 * field to be read back.
+	 * @param name The name of the section, which cannot contain `]` or line
+	 * breaks, or end in whitespace.
+	 * @returns `true` if the section was written, `false` otherwise.
+	 */
+	bool section(std::string_view name);
+
+	/**
+	 * @brief Writes a key-value pair in the current section.
+	 * @param key The key, which cannot contain `=` or line breaks, start with
+	 * `[`, a comment prefix or an include directive, or have surrounding
+	 * whitespace.
+	 * @param value The value, which is quoted if needed and cannot contain
+	 * line breaks or end in whitespace.
+	 * @returns `true` if the pair was written, `false` otherwise.
+	 */
+	bool field(std::string_view key, std::string_view value);
+
+	bool field(std::string_view key, const char *value) {
+		return field(key, std::string_view(value));
+	}
+
+	/**
+	 * @brief Writes a number or boolean in the current section, formatted
+	 * without allocating so that `INIReader` converts it back exactly.
+	 */
+	bool field(std::string_view key, long long value);
+	bool field(std::string_view key, double value);
+	bool field(std::string_view key, bool value);
+
+	bool field(std::string_view key, int value) {
+		return field(key, static_cast<long long>(value));
+	}
+
+	bool field(std::string_view key, long value) {
+		return field(key, static_cast<long long>(value));
+	}
+
+	/**
+	 * @brief Writes a comment on a line of its own.
+	 * @param text The comment, which cannot contain line breaks.
+	 * @returns `true` if the comment was written, `false` otherwise.
+	 */
+	bool comment(std::string_view text);
+
+	/**
+	 * @brief Writes every section and field of a reader.
+	 * @returns `true` if everything was written, `false` otherwise.
+	 */
+	bool write(const INIReader &reader);
+
+	/**
+	 * @brief Passes all buffered text to the sink.
+	 * @returns `true` if everything given to the writer was written, `false`
+	 * otherwise.
+	 */
+	bool flush();
+
+	/**
+	 * @brief Flushes the text and, when writing a file, makes it durable and
+	 * renames it over the file being replaced. The file is left alone if
+	 * anything failed to be written. The writer should not be used
+	 * afterwards.
+	 * @returns `true` if everything was written, `false` otherwise.
+	 */
+	bool commit();
+
+	/**
+	 * @returns `true` if everything given to the writer was written, `false`
+	 * otherwise.
+	 */
+	bool success() const {
+		return !m_failed;
+	}
+
+};
+
+/**
+ * @brief Shares the latest configuration with many threads while another
+ * thread publishes new ones.
+ *
+ * Each reading thread creates its own `Handle`, which caches the snapshot it
+ * last saw. Publishing drops the new snapshot into every handle's mailbox, so
+ * a read only checks a flag in memory that belongs to its own thread: readers
+ * never take a lock, never wait for a writer and never write to memory shared
+ * with other readers. Snapshots are immutable and freed once the last handle
+ * (or other holder) lets go of them.
+ */
+class INIHolder {
+
+public:
+
+	/**
+	 * @brief An immutable configuration that stays valid while it is held.
+	 */
+	using Snapshot = std::shared_ptr<const INIReader>;
+
+private:
+
+	/**
+	 * @brief Where a publisher leaves a new snapshot for one handle, on a
+	 * cache line of its own.
+	 */
+	struct alignas(64) Slot {
+		std::atomic<Snapshot *> mailbox{ nullptr };
+	};
+
+	/**
+	 * @brief Guards `m_current` and `m_slots`. Only publishers and handles
+	 * being created or destroyed take it.
+	 */
+	mutable std::mutex m_mutex;
+
+	/**
+	 * @brief The most recently published snapshot.
+	 */
+	Snapshot m_current;
+
+	/**
+	 * @brief The slots of every live handle.
+	 */
+	std::vector<Slot *> m_slots;
+
+public:
+
+	/**
+	 * @brief A thread's view of the holder. Create one per reading thread
+	 * (for example as a `thread_local`), and destroy it before the holder.
+	 */
+	class Handle {
+
+	private:
+
+		/**
+		 * @brief The holder this handle reads from.
+		 */
+		INIHolder &m_holder;
+
+		/**
+		 * @brief Where new snapshots are delivered.
+		 */
+		std::unique_ptr<Slot> m_slot;
+
+		/**
+		 * @brief The snapshot this handle is currently reading from.
+		 */
+		Snapshot m_snapshot;
+
+	public:
+
+		explicit Handle(INIHolder &holder);
+		~Handle();
+
+		Handle(const Handle &) = delete;
+		Handle &operator=(const Handle &) = delete;
+
+		/**
+		 * @returns The latest configuration. The reference stays valid until
+		 * the next call on this handle.
+		 */
+		const INIReader &get() {
+			// the mailbox is only written when a new snapshot is published
+			if (m_slot->mailbox.load(std::memory_order_acquire)) {
+				const std::unique_ptr<Snapshot> next(m_slot->mailbox.exchange(nullptr, std::memory_order_acq_rel));
+
+				if (next) {
+					m_snapshot = std::move(*next);
+				}
+			}
+
+			return *m_snapshot;
+		}
+
+		const INIReader *operator->() {
+			return &get();
+		}
+
+		/**
+		 * @returns The snapshot `get` currently returns, to keep it alive.
+		 */
+		Snapshot snapshot() {
+			get();
+			return m_snapshot;
+		}
+
+	};
+
+	/**
+	 * @brief Creates a holder that starts out with `initial`.
+	 */
+	explicit INIHolder(Snapshot initial);
+
+	INIHolder(const INIHolder &) = delete;
+	INIHolder &operator=(const INIHolder &) = delete;
+
+	/**
+	 * @brief Makes `next` the configuration every handle sees from its next
+	 * read on.
+	 */
+	void publish(Snapshot next);
+
+	/**
+	 * @returns The most recently published snapshot. This takes a lock, so
+	 * threads that read often should use a `Handle` instead.
+	 */
+	Snapshot load() const;
+
+};
+
+/**
+ * @brief Keeps an `INIReader` up to date with a file on disk. The file (and
+ * the directory it is in, so that editors which save by renaming a new file
+ * over the old one are noticed) is watched with inotify on Linux, as are
+ * the directories its include directives name. Bursts of
+ * changes are collapsed into a single reload, which is parsed on a
+ * background thread and only published if it succeeds.
+ *
+ * On other platforms nothing is watched, but `reload` can still be called.
+ */
+class INIWatcher {
+
+public:
+
+	/**
+	 * @brief Called after a reload that changed something a subscriber is
+	 * interested in, on the thread that did the reload.
+	 * @param previous The configuration before the reload.
+	 * @param current The configuration after the reload.
+	 * @param section The section that changed.
+	 * @param key The key that changed, or empty for section subscriptions.
+	 */
+	using ChangeCallback = std::function<void(
+		const INIReader &previous,
+		const INIReader &current,
+		std::string_view section,
+		std::string_view key
+	)>;
+
+private:
+
+	/**
+	 * @brief A callback for changes to a section, or to one key in it.
+	 */
+	struct Subscription {
+		std::string section;
+		std::string key;
+		ChangeCallback callback;
+	};
+
+	/**
+	 * @brief The path of the watched file.
+	 */
+	std::string m_file_name;
+
+	/**
+	 * @brief How the file is loaded on every reload.
+	 */
+	LoadMode m_mode;
+
+	/**
+	 * @brief How long the file must go without changes before it is reloaded.
+	 */
+	std::chrono::milliseconds m_debounce;
+
+	/**
+	 * @brief The longest a reload waits after the first change, even if the
+	 * file never goes quiet.
+	 */
+	std::chrono::milliseconds m_max_delay;
+
+	/**
+	 * @brief Guards `m_error` and `m_subscriptions`.
+	 */
+	mutable std::mutex m_mutex;
+
+	/**
+	 * @brief Makes sure reloads (and their callbacks) happen one at a time.
+	 */
+	std::mutex m_reload_mutex;
+
+	/**
+	 * @brief Publishes the most recent configuration that was parsed
+	 * successfully.
+	 */
+	INIHolder m_holder;
+
+	/**
+	 * @brief The error of the most recent reload.
+	 */
+	std::string m_error;
+
+	/**
+	 * @brief Everything that should be told about changes.
+	 */
+	std::vector<Subscription> m_subscriptions;
+
+	/**
+	 * @brief The inotify instance, the event used to stop the background
+	 * thread, and the watches on the file and its directory (-1 if unused).
+	 */
+	int m_inotify{ -1 };
+	int m_wake{ -1 };
+	int m_file_watch{ -1 };
+	int m_dir_watch{ -1 };
+
+	/**
+	 * @brief The watches on the directories of the included files.
+	 */
+	std::vector<int> m_include_watches;
+
+	/**
+	 * @brief Waits for changes and reloads the file.
+	 */
+	std::thread m_thread;
+
+	/**
+	 * @brief Body of the background thread.
+	 */
+	void run();
+
+	/**
+	 * @brief Reads all pending inotify events.
+	 * @returns `true` if any of them are about the watched file.
+	 */
+	bool drainEvents();
+
+	/**
+	 * @brief Watches the file that is currently at `m_file_name`, which
+	 * changes whenever a new file is renamed over it.
+	 */
+	void watchFile();
+
+	/**
+	 * @brief Watches the directories the current configuration includes
+	 * files from, so that included files which are added, changed or
+	 * removed are noticed, and stops watching the ones it no longer does.
+	 */
+	void watchIncludes();
+
+public:
+
+	/**
+	 * @brief Loads a file and starts watching it for changes. The first load
+	 * is always published, so check `current()->success()`.
+	 * @param fileName The path of the file to watch.
+	 * @param mode How the file should be loaded.
+	 * @param debounce How long the file must go without changes before it is
+	 * reloaded.
+	 * @param maxDelay The longest a reload waits after the first change, so
+	 * that a file which is written continuously is still reloaded, where `0`
+	 * uses ten times `debounce`.
+	 */
+	explicit INIWatcher(
+		std::string fileName,
+		LoadMode mode = LoadMode::Stream,
+		std::chrono::milliseconds debounce = std::chrono::milliseconds(50),
+		std::chrono::milliseconds maxDelay = std::chrono::milliseconds(0)
+	);
+
+	/**
+	 * @brief Stops watching the file.
+	 */
+	~INIWatcher();
+
+	INIWatcher(const INIWatcher &) = delete;
+	INIWatcher &operator=(const INIWatcher &) = delete;
+
+	/**
+	 * @returns `true` if the file is being watched for changes, `false` otherwise.
+	 */
+	bool isWatching() const;
+
+	/**
+	 * @returns The most recent configuration that was parsed successfully.
+	 * It stays valid (and unchanged) for as long as it is held.
+	 */
+	std::shared_ptr<const INIReader> current() const;
+
+	/**
+	 * @returns The holder new configurations are published to, which
+	 * threads that read often can create handles for.
+	 */
+	INIHolder &holder() {
+		return m_holder;
+	}
+
+	/**
+	 * @returns The error of the most recent reload, which is not published
+	 * if there is one.
+	 */
+	const std::string getError() const;
+
+	/**
+	 * @brief Parses the file again now and publishes it if it succeeds,
+	 * calling the subscribers of anything that changed.
+	 * @returns `true` if the new configuration was published, `false` otherwise.
+	 */
+	bool reload();
+
+	/**
+	 * @brief Calls `callback` after each reload in which any key in `section`
+	 * was added, removed or changed (or the section itself was).
+	 */
+	void onSectionChange(std::string section, ChangeCallback callback);
+
+	/**
+	 * @brief Calls `callback` after each reload in which the value of `key`
+	 * in `section` was added, removed or changed.
+	 */
+	void onKeyChange(std::string section, std::string key, ChangeCallback callback);
 
 };
 
@@ -1,5 +1,93 @@
 #include "../src/ini.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+
+constexpr Setting<int> Master{ "AUDIO", "Master", 0 };
+constexpr Setting<bool> VSync{ "GRAPHICS", "VSYNC", false };
+constexpr Setting<std::string_view> Missing{ "AUDIO", "Missing", "fallback" };
+
+/**
+ * @brief Counts everything the event parser finds.
+ */
+struct CountingHandler : INIHandler {
+	int sections{ 0 };
+	int pairs{ 0 };
+	int comments{ 0 };
+	int errorLine{ 0 };
+
+	bool onSection(std::string_view, int) override {
+		++sections;
+		return true;
+	}
+
+	bool onKeyValue(std::string_view, std::string_view, std::string_view, int) override {
+		++pairs;
+		return true;
+	}
+
+	bool onComment(std::string_view, int) override {
+		++comments;
+		return true;
+	}
+
+	void onError(ErrorCode, int line) override {
+		errorLine = line;
+	}
+};
+
+/**
+ * @brief Records every event the parser sends, so that two ways of parsing
+ * the same text can be compared.
+ */
+struct RecordingHandler : INIHandler {
+	std::vector<std::string> events;
+
+	bool onSection(std::string_view name, int line) override {
+		events.push_back("section " + std::string(name) + ' ' + std::to_string(line));
+		return true;
+	}
+
+	bool onKeyValue(std::string_view section, std::string_view key, std::string_view value, int line) override {
+		events.push_back("pair " + std::string(section) + '|' + std::string(key) + '|' + std::string(value) + ' ' + std::to_string(line));
+		return true;
+	}
+
+	bool onComment(std::string_view comment, int line) override {
+		events.push_back("comment " + std::string(comment) + ' ' + std::to_string(line));
+		return true;
+	}
+
+	void onError(ErrorCode error, int line) override {
+		events.push_back("error " + std::to_string(static_cast<int>(error)) + ' ' + std::to_string(line));
+	}
+};
+
+/**
+ * @brief Builds text whose marked characters move across the 16, 32 and 64
+ * byte blocks of the scanner as `pad` grows, with lines longer than a block
+ * once `pad` passes 64.
+ */
+static std::string blockEdgeText(std::size_t pad, bool crlf, bool finalNewline, bool broken) {
+	const std::string nl = crlf ? "\r\n" : "\n";
+	const std::string p(pad, 'a');
+
+	std::string text = "[S" + p + "]" + nl;
+	text += "k" + p + " = v" + p + " ; c" + p + nl;
+	text += "q" + p + " = \"x ; " + p + "\" # after" + nl;
+	text += "#" + p + nl;
+	text += "e" + p + "=a=b]c#d" + nl;
+	text += "[T]  " + nl + "last = " + p;
+
+	if (broken) {
+		text += nl + "u = \"" + p;
+	}
+
+	return finalNewline ? text + nl : text;
+}
 
 int main() {
 
@@ -13,6 +101,522 @@ int main() {
 		return 1;
 	}
 
+	// tabs around keys, values and comments should be removed like spaces
+	if (reader.getString("GRAPHICS", "Shadows", "") != "high") {
+		std::cout << "Tabs were not removed!\n";
+		return 1;
+	}
+
+	// a section without key-value pairs should be reported
+	INIReader empty("test/empty_section.ini");
+
+	if (empty.success()) {
+		std::cout << "Empty section was not detected!\n";
+		return 1;
+	}
+
+	// ...including the last section, which is not followed by another declaration
+	for (const LoadMode mode : { LoadMode::Stream, LoadMode::Mapped, LoadMode::Parallel }) {
+		if (INIReader("test/empty_last_section.ini", mode, 2).getError() != errorStrings[static_cast<int>(ErrorCode::EmptySection)]) {
+			std::cout << "Empty last section was not detected!\n";
+			return 1;
+		}
+	}
+
+	if (INIReader::fromString("[A]\nk = v\n[B]\n").success()) {
+		std::cout << "Empty last section in memory was not detected!\n";
+		return 1;
+	}
+
+	// the event parser should see every part of the file
+	CountingHandler counts;
+	INIParser(counts).parseFile("test/valid.ini");
+
+	if (counts.sections != 3 || counts.pairs != 7 || counts.comments != 4) {
+		std::cout << "Event parser missed parts of the file!\n";
+		return 1;
+	}
+
+	CountingHandler emptyCounts;
+	if (INIParser(emptyCounts).parseFile("test/empty_section.ini") != ErrorCode::EmptySection || emptyCounts.errorLine != 3) {
+		std::cout << "Event parser reported the wrong error!\n";
+		return 1;
+	}
+
+	CountingHandler lastCounts;
+	INIParser lastParser(lastCounts);
+	lastParser.parseLine("[A]");
+
+	if (lastParser.finish() != ErrorCode::EmptySection || lastCounts.errorLine != 1) {
+		std::cout << "Event parser missed the empty last section!\n";
+		return 1;
+	}
+
+	// statistics should count every part of the file, and only be collected when asked for
+	const LoadStats &stats = reader.getLoadStats();
+
+#if COLLECT_LOAD_STATS
+	if (stats.sections != 3 || stats.fields != 7 || stats.comments != 4 || stats.bytes == 0 || stats.total.count() <= 0) {
+#else
+	if (stats.sections != 0 || stats.fields != 0 || stats.total.count() != 0) {
+#endif
+		std::cout << "Load statistics do not match!\n";
+		return 1;
+	}
+
+	// the block scanner should find exactly what scanning one byte at a time finds, wherever the
+	// marked characters fall in a block
+	for (std::size_t pad = 0; pad <= 140; ++pad) {
+		for (const int variant : { 0, 1, 2, 3, 4 }) {
+			const std::string text = blockEdgeText(pad, variant & 1, variant & 2, variant == 4);
+
+			RecordingHandler blocks;
+			INIParser(blocks).parse(text);
+
+			RecordingHandler stream;
+			std::istringstream in(text);
+			INIParser(stream).parseStream(in);
+
+			RecordingHandler lines;
+			INIParser byLine(lines);
+			for (std::size_t start = 0; start <= text.length();) {
+				const std::size_t end = std::min(text.find('\n', start), text.length());
+
+				if (!byLine.parseLine(std::string_view(text).substr(start, end - start))) {
+					break;
+				}
+
+				start = end + 1;
+			}
+			byLine.finish();
+
+			if (lines.events.size() < 8 || blocks.events != lines.events || stream.events != lines.events) {
+				std::cout << "Block scanner does not match the byte scanner with padding " << pad << "!\n";
+				return 1;
+			}
+		}
+	}
+
+	// memory-mapped and parallel loading should give exactly the same result
+	const auto names = reader.getSectionNames();
+
+	for (const LoadMode mode : { LoadMode::Mapped, LoadMode::Parallel }) {
+		const char *label = (mode == LoadMode::Mapped) ? "Mapped" : "Parallel";
+		INIReader other("test/valid.ini", mode, 2);
+		const auto otherNames = other.getSectionNames();
+
+		if (!other.success() || !std::equal(names.begin(), names.end(), otherNames.begin(), otherNames.end())) {
+			std::cout << label << " reader does not match!\n";
+			return 1;
+		}
+
+		for (const auto &sec : names) {
+			const auto fields = reader.getSectionFields(sec);
+			const auto otherFields = other.getSectionFields(sec);
+
+			if (!std::equal(fields.begin(), fields.end(), otherFields.begin(), otherFields.end())) {
+				std::cout << label << " fields do not match in section " << sec << "!\n";
+				return 1;
+			}
+		}
+	}
+
+#if defined(__unix__)
+	// only regular files should be mapped, since other files have no size to map
+	if (INIReader("/dev/null", LoadMode::Mapped).getError() != errorStrings[static_cast<int>(ErrorCode::NoSuchFile)]) {
+		std::cout << "A device was mapped!\n";
+		return 1;
+	}
+#endif
+
+	// an empty section should be found even when the next section is parsed on another thread
+	if (INIReader("test/empty_section.ini", LoadMode::Parallel, 4).getError() != errorStrings[static_cast<int>(ErrorCode::EmptySection)]) {
+		std::cout << "Parallel reader missed the empty section!\n";
+		return 1;
+	}
+
+#if ALLOW_INCLUDES
+	// included files should be found relative to the including file, which takes precedence over them
+	std::filesystem::create_directory("test/parts");
+	std::ofstream("test/included.ini") << "!include parts/*.ini\n[A]\nx = 1\n";
+	std::ofstream("test/parts/a.ini") << "[B]\nz = 4\n";
+	std::ofstream("test/parts/b.ini") << "[A]\nx = 2\ny = 2\n[B]\nz = 3\n";
+	std::ofstream("test/parts/loop.inc") << "!include \"../cycle.ini\"\n";
+	std::ofstream("test/cycle.ini") << "[A]\nx = 1\n!include parts/loop.inc\n";
+
+	for (const LoadMode mode : { LoadMode::Stream, LoadMode::Mapped, LoadMode::Parallel }) {
+		const INIReader included("test/included.ini", mode, 2);
+
+		if (!included.success() || included.getInt("A", "x", 0) != 1 || included.getInt("A", "y", 0) != 2 || included.getInt("B", "z", 0) != 4
+			|| INIReader("test/cycle.ini", mode).getError() != errorStrings[static_cast<int>(ErrorCode::IncludeCycle)]) {
+			std::cout << "Included files were not read correctly!\n";
+			return 1;
+		}
+	}
+
+	if (INIReader::fromString("!include parts/missing.ini\n", "test").getError() != errorStrings[static_cast<int>(ErrorCode::NoSuchInclude)]) {
+		std::cout << "Missing include was not detected!\n";
+		return 1;
+	}
+
+	// text in memory should not read files unless given a directory
+	const INIReader untrusted = INIReader::fromString("[S]\nk = 1\n!include test/included.ini\n");
+
+	if (untrusted.getError() != errorStrings[static_cast<int>(ErrorCode::IncludeNotAllowed)] || untrusted.getSectionNames().size() != 1
+		|| !INIReader::fromView("!include included.ini\n", "test").success()) {
+		std::cout << "Include in memory text was followed without a directory!\n";
+		return 1;
+	}
+
+	// files with includes should not be cached, since the cache only describes the file that includes them
+	if (INIReader::fromCache("test/included.ini", "test/included.ini.cache").getInt("A", "y", 0) != 2 || std::ifstream("test/included.ini.cache")) {
+		std::cout << "File with includes was cached!\n";
+		return 1;
+	}
+
+	// included text should be copied unless the including file is mapped, so editing it in place cannot affect the reader
+	{
+		const INIReader copied("test/included.ini");
+		std::ofstream("test/parts/b.ini").close();
+
+		if (copied.getStringView("A", "y", "") != "2") {
+			std::cout << "Reader depends on the text of an included file!\n";
+			return 1;
+		}
+	}
+
+	// a wildcard that matches nothing yet should not be cached, and its directory should be watched for new files
+	std::ofstream("test/globbed.ini") << "[A]\nx = 1\n!include parts/new-*.ini\n";
+
+	if (!INIReader::fromCache("test/globbed.ini", "test/globbed.ini.cache").success() || std::ifstream("test/globbed.ini.cache")) {
+		std::cout << "File with an empty wildcard include was cached!\n";
+		return 1;
+	}
+
+	{
+		INIWatcher watcher("test/globbed.ini", LoadMode::Stream, std::chrono::milliseconds(20));
+		std::atomic<int> cChanges{ 0 };
+
+		watcher.onSectionChange("C", [&](const INIReader &, const INIReader &, std::string_view, std::string_view) { ++cChanges; });
+		std::ofstream("test/parts/new-c.ini") << "[C]\nw = 1\n";
+
+		for (int i = 0; i < 500 && watcher.isWatching() && cChanges == 0; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		if (watcher.isWatching() && (cChanges != 1 || watcher.current()->getInt("C", "w", 0) != 1)) {
+			std::cout << "Watcher missed a file added to an included directory!\n";
+			return 1;
+		}
+	}
+
+	std::remove("test/globbed.ini");
+	std::filesystem::remove_all("test/parts");
+	std::remove("test/included.ini");
+	std::remove("test/cycle.ini");
+#endif
+
+	// copies should find the same values as the original
+	const INIReader copy = reader;
+
+	if (copy.getString("AUDIO", "Master", "") != reader.getString("AUDIO", "Master", "")) {
+		std::cout << "Copied reader does not match!\n";
+		return 1;
+	}
+
+	// values that are not numbers should be reported instead of throwing
+	if (reader.tryGetInt("WINDOW", "Title").error != ConversionError::InvalidFormat || reader.getInt("WINDOW", "Title", -1) != -1) {
+		std::cout << "Invalid number was not detected!\n";
+		return 1;
+	}
+
+	// parsing from memory should follow the same rules as parsing a file
+	const INIReader fromString = INIReader::fromString("[WINDOW]\nTitle = \"Title of the window\" ; comment\r\n");
+
+	if (!fromString.success() || fromString.getString("WINDOW", "Title", "") != reader.getString("WINDOW", "Title", "")) {
+		std::cout << "Reader created from string does not match!\n";
+		return 1;
+	}
+
+	// a cache should give the same result without parsing, and be ignored once the file changes
+	std::ofstream("test/cached.ini") << "[A]\nx = 1\ny = yes\n[B]\nz = 2.5\n";
+	std::remove("test/cached.ini.cache");
+
+	const INIReader parsed = INIReader::fromCache("test/cached.ini", "test/cached.ini.cache");
+	const INIReader restored = INIReader::fromCache("test/cached.ini", "test/cached.ini.cache");
+
+	if (parsed.loadedFromCache() || !restored.loadedFromCache() || restored.getInt("A", "x", 0) != 1
+		|| !restored.getBool("A", "y", false) || restored.getDouble("B", "z", 0.0) != 2.5 || restored.getSectionNames().size() != 2) {
+		std::cout << "Cached reader does not match!\n";
+		return 1;
+	}
+
+	// a file parsed on a cache miss may be truncated in place without affecting the reader
+	std::ofstream("test/cached.ini").close();
+
+	if (parsed.getStringView("A", "y", "") != "yes" || parsed.getSectionNames().size() != 2) {
+		std::cout << "Reader parsed on a cache miss depends on its file!\n";
+		return 1;
+	}
+
+	// same size, and possibly the same modification time, so only the contents differ
+	std::ofstream("test/cached.ini") << "[A]\nx = 7\ny = yes\n[B]\nz = 2.5\n";
+
+	if (INIReader::fromCache("test/cached.ini", "test/cached.ini.cache").getInt("A", "x", 0) != 7) {
+		std::cout << "Out of date cache was used!\n";
+		return 1;
+	}
+
+	std::remove("test/cached.ini");
+	std::remove("test/cached.ini.cache");
+
+	// written text should read back exactly, including values that need quoting
+	std::string written;
+	{
+		INIWriter writer(written);
+		writer.write(reader);
+		writer.section("TRICKY");
+		writer.field("Comment", "a ; b # c");
+		writer.field("Quoted", "\"already\" quoted");
+		writer.field("Leading", "  spaces");
+		writer.field("Empty", "");
+		writer.field("Number", 0.1);
+
+		if (writer.field("Broken", "two\nlines") || writer.success()) {
+			std::cout << "Writer accepted a value it cannot write!\n";
+			return 1;
+		}
+	}
+
+	const INIReader rewritten = INIReader::fromString(written);
+
+	for (const auto &sec : names) {
+		const auto fields = reader.getSectionFields(sec);
+		const auto otherFields = rewritten.tryGetSectionFields(sec);
+
+		if (!std::equal(fields.begin(), fields.end(), otherFields.begin(), otherFields.end())) {
+			std::cout << "Written section " << sec << " does not match!\n";
+			return 1;
+		}
+	}
+
+	if (!rewritten.success() || rewritten.getStringView("TRICKY", "Comment", "") != "a ; b # c" || rewritten.getStringView("TRICKY", "Quoted", "") != "\"already\" quoted"
+		|| rewritten.getStringView("TRICKY", "Leading", "") != "  spaces" || rewritten.getStringView("TRICKY", "Empty", "x") != "x"
+		|| rewritten.getDouble("TRICKY", "Number", 0.0) != 0.1 || rewritten.tryGetSectionFields("TRICKY").size() != 5) {
+		std::cout << "Written values do not match!\n";
+		return 1;
+	}
+
+	// keys that would read back as an include directive should be refused, while similar keys are written
+	{
+		std::string text;
+		INIWriter writer(text);
+		writer.section("S");
+		writer.field("!included", "x");
+
+#if ALLOW_INCLUDES
+		const bool refused = !writer.field("!include", "x") && !writer.field("!include y", "x") && !writer.success();
+#else
+		const bool refused = true;
+#endif
+		writer.flush();
+
+		const INIReader readBack = INIReader::fromString(text);
+
+		if (!refused || !readBack.success() || readBack.getStringView("S", "!included", "") != "x") {
+			std::cout << "Writer wrote a key that reads back as an include!\n";
+			return 1;
+		}
+	}
+
+	// a file should only be replaced once it is committed
+	{
+		INIWriter writer("test/written.ini");
+		writer.write(reader);
+
+		if (std::ifstream("test/written.ini").good() || !writer.commit() || INIReader("test/written.ini").getString("WINDOW", "Title", "") != reader.getString("WINDOW", "Title", "")) {
+			std::cout << "Written file was not replaced atomically!\n";
+			return 1;
+		}
+	}
+
+	std::remove("test/written.ini");
+
+	// later layers should override earlier ones without copying their text
+	const INIReader defaults = INIReader::fromString("[A]\nx = 1\ny = 2\n[B]\nz = 3\n");
+	const INIReader host = INIReader::fromString("[A]\nx = 5\ny = \"\"\n[C]\nw = 7\n");
+	const INIReader layered = INIReader::fromLayers({ defaults, host });
+
+	if (!layered.success() || layered.getInt("A", "x", 0) != 5 || layered.getInt("A", "y", 0) != 2 || layered.getInt("C", "w", 0) != 7
+		|| layered.getStringView("B", "z", "").data() != defaults.getStringView("B", "z", "").data() || layered.getSectionNames().size() != 3
+		|| layered.getSectionFields("A").size() != 2 || layered.getLayer("A", "x") != 1 || layered.getLayer("A", "y") != 0
+		|| layered.getLayer("A", "Missing") != -1 || reader.getLayer("AUDIO", "Master") != 0) {
+		std::cout << "Layered reader does not match!\n";
+		return 1;
+	}
+
+	// missing sections should give no fields instead of throwing
+	if (!reader.tryGetSectionFields("MISSING").empty()) {
+		std::cout << "Missing section has fields!\n";
+		return 1;
+	}
+
+	// settings resolved up front should match the getters
+	const SettingTable<Master, VSync, Missing> settings(reader);
+
+	if (settings.get<Master>() != reader.getInt("AUDIO", "Master", 0) || settings.get<VSync>() != reader.getBool("GRAPHICS", "VSYNC", false)
+		|| settings.get<Missing>() != "fallback" || settings.getError<Missing>() != ConversionError::MissingValue) {
+		std::cout << "Setting table does not match!\n";
+		return 1;
+	}
+
+	// a batch of lookups should give the same values as the getters
+	const Lookup lookups[]{
+		{ "WINDOW", "Title", "untitled" },
+		{ "AUDIO", "Master", 0.0 },
+		{ "AUDIO", "Missing", 7 },
+		{ "GRAPHICS", "VSYNC", false },
+		{ "WINDOW", "Title", 3L }
+	};
+	LookupResult results[std::size(lookups)];
+	reader.getMany(lookups, results);
+
+	if (results[0].value.string != reader.getStringView("WINDOW", "Title", "") || results[1].value.real != reader.getDouble("AUDIO", "Master", 0.0)
+		|| results[2].value.integer != 7 || results[2].error != ConversionError::MissingValue || results[3].value.boolean != reader.getBool("GRAPHICS", "VSYNC", false)
+		|| results[4].value.integer != 3 || results[4].error != ConversionError::InvalidFormat) {
+		std::cout << "Batch lookup does not match!\n";
+		return 1;
+	}
+
+	// every typed read of an existing value should be served from the load-time conversion, whichever API made it
+	{
+		constexpr Setting<double> Volume{ "A", "x", 0.0 };
+		const INIReader converted = INIReader::fromString("[A]\nx = 1\n");
+		const Lookup typedLookups[]{ { "A", "x", 0 }, { "A", "x", "" }, { "A", "Missing", false } };
+		LookupResult typedResults[std::size(typedLookups)];
+
+		converted.getInt("A", "x", 0);
+		converted.getString("A", "x", "");
+		converted.getBool("A", "Missing", false);
+		converted.tryGet(Volume);
+		converted.getMany(typedLookups, typedResults);
+
+#if COUNT_CACHED_CONVERSIONS
+		if (converted.getCachedConversions() != 3) {
+#else
+		if (converted.getCachedConversions() != 0) {
+#endif
+			std::cout << "Cached conversions were not counted!\n";
+			return 1;
+		}
+	}
+
+	// reads on every thread should be counted per key, with the most read keys first
+	{
+		const INIReader counted = INIReader::fromString("[A]\nx = 1\ny = 2\n");
+		std::thread other([&]() {
+			counted.getInt("A", "x", 0);
+			counted.getStringView("A", "x", "");
+		});
+
+		// reading from another reader in between should not mix up their counts
+		const INIReader second = INIReader::fromString("[A]\ny = 2\n");
+
+		counted.getInt("A", "x", 0);
+		second.getInt("A", "y", 0);
+		counted.getBool("A", "Missing", false);
+		second.getInt("A", "y", 0);
+		other.join();
+
+		const std::vector<KeyAccess> accesses = counted.getKeyAccesses();
+		const std::vector<KeyAccess> secondAccesses = second.getKeyAccesses();
+
+#if COUNT_KEY_ACCESSES
+		if (accesses.size() != 2 || accesses[0].key != "x" || accesses[0].hits != 3 || accesses[1].key != "Missing" || accesses[1].misses != 1
+			|| secondAccesses.size() != 1 || secondAccesses[0].hits != 2) {
+#else
+		if (!accesses.empty() || !secondAccesses.empty()) {
+#endif
+			std::cout << "Key accesses were not counted!\n";
+			return 1;
+		}
+	}
+
+	// reloading should only report the keys and sections that changed
+	std::ofstream("test/watched.ini") << "[A]\nx = 1\ny = 2\n[B]\nz = 3\n";
+
+	{
+		INIWatcher watcher("test/watched.ini");
+		std::atomic<int> xChanges{ 0 }, yChanges{ 0 }, bChanges{ 0 };
+
+		watcher.onKeyChange("A", "x", [&](const INIReader &, const INIReader &, std::string_view, std::string_view) { ++xChanges; });
+		watcher.onKeyChange("A", "y", [&](const INIReader &, const INIReader &, std::string_view, std::string_view) { ++yChanges; });
+		watcher.onSectionChange("B", [&](const INIReader &, const INIReader &, std::string_view, std::string_view) { ++bChanges; });
+
+		std::ofstream("test/watched.ini") << "[A]\nx = 5\ny = 2\n[B]\nz = 3\n";
+
+		if (!watcher.reload() || watcher.current()->getInt("A", "x", 0) != 5 || xChanges != 1 || yChanges != 0 || bChanges != 0) {
+			std::cout << "Reload did not report the right changes!\n";
+			return 1;
+		}
+
+		// a broken file should not replace the working configuration
+		std::ofstream("test/watched.ini") << "[A]\nx = \"unterminated\n";
+
+		if (watcher.reload() || watcher.current()->getInt("A", "x", 0) != 5) {
+			std::cout << "Broken reload was published!\n";
+			return 1;
+		}
+
+		// editors that save by renaming a new file over the old one should be noticed
+		std::ofstream("test/watched.ini.tmp") << "[A]\nx = 5\ny = 2\n[B]\nz = 4\n";
+		std::rename("test/watched.ini.tmp", "test/watched.ini");
+
+		for (int i = 0; i < 500 && watcher.isWatching() && bChanges == 0; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		if (watcher.isWatching() && (bChanges != 1 || watcher.current()->getInt("B", "z", 0) != 4)) {
+			std::cout << "Watcher missed a change to the file!\n";
+			return 1;
+		}
+	}
+
+	// a file that is written continuously should still be reloaded once the maximum delay has passed
+	std::ofstream("test/watched.ini") << "[A]\nk0 = 0\n";
+
+	{
+		INIWatcher watcher("test/watched.ini", LoadMode::Stream, std::chrono::milliseconds(50), std::chrono::milliseconds(200));
+		std::atomic<int> aChanges{ 0 };
+
+		watcher.onSectionChange("A", [&](const INIReader &, const INIReader &, std::string_view, std::string_view) { ++aChanges; });
+
+		// appending every 10 ms never leaves the file quiet for the debounce period
+		for (int i = 1; i <= 300 && watcher.isWatching() && aChanges == 0; ++i) {
+			std::ofstream("test/watched.ini", std::ios::app) << 'k' << i << " = " << i << '\n';
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		if (watcher.isWatching() && aChanges == 0) {
+			std::cout << "Watcher never reloaded a file that kept changing!\n";
+			return 1;
+		}
+	}
+
+	std::remove("test/watched.ini");
+
+	// handles should pick up a new snapshot on their next read
+	INIHolder holder(std::make_shared<const INIReader>(reader));
+	INIHolder::Handle handle(holder);
+	const INIHolder::Snapshot first = handle.snapshot();
+
+	holder.publish(std::make_shared<const INIReader>(INIReader::fromString("[AUDIO]\nMaster = 11\n")));
+
+	if (handle->getInt("AUDIO", "Master", 0) != 11 || first->getInt("AUDIO", "Master", 0) != reader.getInt("AUDIO", "Master", 0)) {
+		std::cout << "Snapshot holder did not publish!\n";
+		return 1;
+	}
+
 	std::string title = reader.getString("WINDOW", "Title", "");
 
 	double fov = reader.getDouble("GRAPHICS", "FOV", 0.0);